@@ -0,0 +1,363 @@
+// Headless benchmark for the node graph editor
+//
+// Builds synthetic graphs from GetNodeTypes() and drives ProcessNodes with scripted
+// ImGuiIO input, no window and no renderer: ImGui::Render only builds the draw
+// lists. For every layout and zoom level it reports frame times and the number
+// of heap allocations per scripted phase.
+//
+//   nodes_bench [nodes] [links] [frames per phase] [seed] [retained 0/1]
+
+#include "NodesEdit.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// allocation counting
+
+static std::atomic<uint64_t> allocations(0);
+static std::atomic<uint64_t> allocated_bytes(0);
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    allocated_bytes += size;
+
+    if (void* p = malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+enum BenchLayout
+{
+    BenchLayout_Grid,       // evenly spread, few nodes on screen
+    BenchLayout_Random,     // uniform over the same area
+    BenchLayout_Cluster,    // everything inside one screen, worst case for drawing and picking
+    BenchLayout_COUNT
+};
+
+static const char* layout_names[BenchLayout_COUNT] = { "grid", "random", "cluster" };
+static const float zoom_levels[] = { 0.3f, 1.0f, 3.0f };
+
+static const ImVec2 display_size(1920.0f, 1080.0f);
+
+// exposes the editor internals a script needs
+class BenchEditor : public ImGui::NodeEditor
+{
+public:
+    size_t rejected_links = 0;
+
+    void Generate(size_t node_count, size_t link_count, BenchLayout layout, std::mt19937& rng)
+    {
+        ClearGraph();
+
+        const float side = sqrtf((float)node_count) * 250.0f;
+        std::uniform_real_distribution<float> area(0.0f, side);
+        std::uniform_real_distribution<float> screen_x(0.0f, display_size.x);
+        std::uniform_real_distribution<float> screen_y(0.0f, display_size.y);
+        const size_t columns = (size_t)sqrtf((float)node_count) + 1;
+
+        std::vector<NodePad*> outputs, inputs;
+
+        const ImGui::NodeTypeRegistry& types = ImGui::GetNodeTypes();
+
+        for (size_t i = 0; i < node_count; ++i)
+        {
+            ImVec2 position;
+            switch (layout)
+            {
+                case BenchLayout_Grid: position = ImVec2((i % columns) * 250.0f, (i / columns) * 150.0f); break;
+                case BenchLayout_Random: position = ImVec2(area(rng), area(rng)); break;
+                default: position = ImVec2(screen_x(rng), screen_y(rng)); break;
+            }
+
+            Node* node = CreateNodeFromType(position, types[rng() % types.Size()]);
+
+            for (NodePad* pad : node->pads)
+            {
+                if (pad->access_flags & ImGui::NodePadAccess_Read) outputs.push_back(pad);
+                if (pad->access_flags & ImGui::NodePadAccess_Write) inputs.push_back(pad);
+            }
+        }
+        selection_.Clear();
+
+        rejected_links = 0;
+        if (outputs.empty() || inputs.empty())
+        {
+            return;
+        }
+
+        const ImGui::NodeFormatTable& formats = ImGui::GetNodeFormats();
+        for (size_t attempt = 0; node_links.size() < link_count && attempt < link_count * 4; ++attempt)
+        {
+            NodePad* source = outputs[rng() % outputs.size()];
+            NodePad* sink = inputs[rng() % inputs.size()];
+
+            if (source->owner == sink->owner || !formats.IsCompatible(source->format_id, sink->format_id))
+            {
+                continue;
+            }
+
+            rejected_links += AddNodePadLink(source, sink) ? 0 : 1;
+        }
+    }
+
+    void SetView(float scale)
+    {
+        canvas_scale_ = scale;
+        canvas_scroll_ = ImVec2(0.0f, 0.0f);
+    }
+
+    ImVec2 CanvasToScreen(ImVec2 position) const
+    {
+        return canvas_position_ + canvas_scroll_ + position * canvas_scale_;
+    }
+
+    // point over the title of a selected node fully on screen, to grab for dragging
+    bool FindGrabPoint(ImVec2& point) const
+    {
+        for (Node* node : nodes_)
+        {
+            const ImVec2 min = CanvasToScreen(node->position_);
+            const ImVec2 max = CanvasToScreen(node->position_ + node->size_);
+            if (selection_.Contains(node->id_) && min.x > 0.0f && min.y > 0.0f && max.x < display_size.x && max.y < display_size.y)
+            {
+                point = ImVec2((min.x + max.x) * 0.5f, min.y + 4.0f);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // point near the top left of the screen with no node around, to start a rubber band
+    bool FindEmptyPoint(ImVec2& point) const
+    {
+        for (float y = 8.0f; y < display_size.y * 0.5f; y += 8.0f)
+        {
+            for (float x = 8.0f; x < display_size.x * 0.5f; x += 8.0f)
+            {
+                const ImRect probe(ImVec2(x, y) - ImVec2(4.0f, 4.0f), ImVec2(x, y) + ImVec2(4.0f, 4.0f));
+                bool empty = true;
+
+                for (Node* node : nodes_)
+                {
+                    if (probe.Overlaps(ImRect(CanvasToScreen(node->position_), CanvasToScreen(node->position_ + node->size_))))
+                    {
+                        empty = false;
+                        break;
+                    }
+                }
+
+                if (empty)
+                {
+                    point = ImVec2(x, y);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    size_t GetNodeCount() const { return nodes_.size(); }
+    size_t GetLinkCount() const { return node_links.size(); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct BenchPhase
+{
+    std::vector<float> frame_ms;
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+static void Frame(BenchEditor& editor)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    io.DeltaTime = 1.0f / 60.0f;
+
+    ImGui::NewFrame();
+
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(display_size);
+    ImGui::Begin("bench", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings);
+    editor.ProcessNodes();
+    ImGui::End();
+
+    ImGui::Render();
+}
+
+// runs frames, script sets up the input of frame i before it runs
+template<typename F>
+static BenchPhase Run(BenchEditor& editor, int frames, F script)
+{
+    BenchPhase phase;
+    phase.frame_ms.reserve(frames);
+
+    const uint64_t allocations_start = allocations;
+    const uint64_t bytes_start = allocated_bytes;
+
+    for (int i = 0; i < frames; ++i)
+    {
+        script(ImGui::GetIO(), i);
+
+        const auto start = std::chrono::steady_clock::now();
+        Frame(editor);
+        phase.frame_ms.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    phase.allocations = allocations - allocations_start;
+    phase.bytes = allocated_bytes - bytes_start;
+    return phase;
+}
+
+static void Report(const char* layout, float zoom, const char* name, BenchPhase& phase)
+{
+    std::vector<float>& ms = phase.frame_ms;
+    if (ms.empty())
+    {
+        return;
+    }
+
+    float sum = 0.0f;
+    for (float value : ms) sum += value;
+    std::sort(ms.begin(), ms.end());
+
+    const size_t frames = ms.size();
+    printf("%-8s %5.1f %-10s %6zu %9.3f %9.3f %9.3f %9.3f %10.1f %12.1f\n", layout, zoom, name, frames,
+        sum / frames, ms[frames / 2], ms[std::min(frames - 1, frames * 99 / 100)], ms.back(),
+        (double)phase.allocations / frames, (double)phase.bytes / frames);
+}
+
+static void ResetInput(ImGuiIO& io)
+{
+    io.MousePos = ImVec2(-1.0f, -1.0f);
+    for (bool& down : io.MouseDown) down = false;
+    for (bool& down : io.KeysDown) down = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv)
+{
+    const size_t node_count = argc > 1 ? (size_t)atol(argv[1]) : 10000;
+    const size_t link_count = argc > 2 ? (size_t)atol(argv[2]) : 100000;
+    const int frames = argc > 3 ? atoi(argv[3]) : 120;
+    const unsigned seed = argc > 4 ? (unsigned)atol(argv[4]) : 1;
+    const bool retained = argc > 5 ? atoi(argv[5]) != 0 : true;
+
+    ImGui::CreateContext();
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = display_size;
+    io.IniFilename = nullptr;
+    io.KeyMap[ImGuiKey_Delete] = ImGuiKey_Delete;
+
+    // no renderer: build the font atlas and never upload it
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    BenchEditor editor;
+    editor.SetRetainedRendering(retained);
+
+    printf("%-8s %5s %-10s %6s %9s %9s %9s %9s %10s %12s\n", "layout", "zoom", "phase", "frames", "avg ms", "p50 ms", "p99 ms", "max ms", "allocs/f", "bytes/f");
+
+    for (int layout = 0; layout < BenchLayout_COUNT; ++layout)
+    {
+        for (float zoom : zoom_levels)
+        {
+            std::mt19937 rng(seed);
+
+            const auto build_start = std::chrono::steady_clock::now();
+            editor.Generate(node_count, link_count, (BenchLayout)layout, rng);
+            const float build_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - build_start).count();
+
+            editor.SetView(zoom);
+            ResetInput(io);
+
+            printf("# %s zoom %.1f: %zu nodes, %zu links (%zu refused as cycles), built in %.1f ms\n",
+                layout_names[layout], zoom, editor.GetNodeCount(), editor.GetLinkCount(), editor.rejected_links, build_ms);
+
+            // first frame deselects everything the generator created
+            BenchPhase warmup = Run(editor, 2, [](ImGuiIO&, int) {});
+            (void)warmup;
+
+            BenchPhase idle = Run(editor, frames, [](ImGuiIO& io, int) { io.MousePos = ImVec2(-1.0f, -1.0f); });
+            Report(layout_names[layout], zoom, "idle", idle);
+
+            // sweep the mouse diagonally over the canvas
+            BenchPhase hover = Run(editor, frames, [frames](ImGuiIO& io, int i)
+            {
+                const float t = (float)i / (float)frames;
+                io.MousePos = ImVec2(t * display_size.x, t * display_size.y);
+            });
+            Report(layout_names[layout], zoom, "hover", hover);
+
+            // rubber band from an empty spot to the bottom right, released on the last frame
+            ImVec2 band_start;
+            if (!editor.FindEmptyPoint(band_start))
+            {
+                printf("#   no empty canvas to start a selection\n");
+                continue;
+            }
+
+            const ImVec2 band_end(display_size.x * 0.75f, display_size.y * 0.75f);
+            BenchPhase select = Run(editor, frames, [frames, band_start, band_end](ImGuiIO& io, int i)
+            {
+                const float t = (float)i / (float)(frames - 1);
+                io.MousePos = band_start + (band_end - band_start) * t;
+                io.MouseDown[0] = i > 0 && i + 1 < frames;
+            });
+            Report(layout_names[layout], zoom, "select", select);
+
+            // drag the selection by one of its nodes, shift keeps it selected on release
+            ImVec2 grab;
+            if (editor.FindGrabPoint(grab))
+            {
+                BenchPhase drag = Run(editor, frames, [frames, grab](ImGuiIO& io, int i)
+                {
+                    io.MousePos = grab + ImVec2((float)i, (float)i) * (200.0f / frames);
+                    io.MouseDown[0] = i > 0 && i + 1 < frames;
+                    io.KeyShift = i > 0;
+                });
+                Report(layout_names[layout], zoom, "drag", drag);
+            }
+            io.KeyShift = false;
+
+            // delete the selection, then let the editor settle
+            const size_t nodes_before = editor.GetNodeCount();
+            BenchPhase remove = Run(editor, frames, [](ImGuiIO& io, int i)
+            {
+                io.KeysDown[io.KeyMap[ImGuiKey_Delete]] = i == 0;
+            });
+            Report(layout_names[layout], zoom, "delete", remove);
+
+            printf("#   deleted %zu nodes, %zu nodes and %zu links left\n", nodes_before - editor.GetNodeCount(), editor.GetNodeCount(), editor.GetLinkCount());
+        }
+    }
+
+    editor.ClearGraph();
+    ImGui::DestroyContext();
+    return 0;
+}
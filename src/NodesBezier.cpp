@@ -0,0 +1,187 @@
+// Bezier flattening and distance queries for the node graph editor
+
+#include "NodesBezier.h"
+
+#if !defined(NODES_EDIT_NO_SIMD) && defined(__AVX__)
+#include <immintrin.h>
+#define NODES_EDIT_SIMD_WIDTH 8
+#elif !defined(NODES_EDIT_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define NODES_EDIT_SIMD_WIDTH 4
+#endif
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    int GetBezierSegmentCount(const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, float tolerance, int max_segments)
+    {
+        const ImVec2 d1 = p1 - (p2 * 2.0f) + p3;
+        const ImVec2 d2 = p2 - (p3 * 2.0f) + p4;
+        const float bend = sqrtf(ImMax(d1.x * d1.x + d1.y * d1.y, d2.x * d2.x + d2.y * d2.y));
+
+        // n >= sqrt(d * (d - 1) / 8 * bend / tolerance) for a curve of degree d = 3
+        const int segments = (int)ceilf(sqrtf(0.75f * bend / tolerance));
+
+        return ImClamp(segments, 1, max_segments);
+    }
+
+    void FlattenBezier(const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, int segments, std::vector<ImVec2>& points)
+    {
+        points.resize(segments + 1);
+        points[0] = p1;
+
+        for (int i = 1; i < segments; ++i)
+        {
+            const float t = (float)i / (float)segments;
+            const float u = 1.0f - t;
+
+            const float w1 = u * u * u;
+            const float w2 = 3.0f * u * u * t;
+            const float w3 = 3.0f * u * t * t;
+            const float w4 = t * t * t;
+
+            points[i] = ImVec2(w1 * p1.x + w2 * p2.x + w3 * p3.x + w4 * p4.x, w1 * p1.y + w2 * p2.y + w3 * p3.y + w4 * p4.y);
+        }
+
+        points[segments] = p4;
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    static void AccumulateScalar(const ImVec2& point, const SegmentBatch& batch, size_t begin, SegmentHit& hit)
+    {
+        for (size_t i = begin; i < batch.Size(); ++i)
+        {
+            const float distance_squared = GetSquaredDistancePointSegment(point, ImVec2(batch.ax[i], batch.ay[i]), ImVec2(batch.bx[i], batch.by[i]));
+
+            if (distance_squared < hit.distance_squared)
+            {
+                hit.owner = batch.owner[i];
+                hit.distance_squared = distance_squared;
+            }
+        }
+    }
+
+    SegmentHit GetNearestSegmentScalar(const ImVec2& point, const SegmentBatch& batch)
+    {
+        SegmentHit hit = { -1, FLT_MAX };
+        AccumulateScalar(point, batch, 0, hit);
+        return hit;
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+#ifdef NODES_EDIT_SIMD_WIDTH
+
+#if NODES_EDIT_SIMD_WIDTH == 8
+    typedef __m256 simd_t;
+
+    static inline simd_t SimdSet(float f) { return _mm256_set1_ps(f); }
+    static inline simd_t SimdLoad(const float* p) { return _mm256_loadu_ps(p); }
+    static inline void SimdStore(float* p, simd_t a) { _mm256_storeu_ps(p, a); }
+    static inline simd_t SimdAdd(simd_t a, simd_t b) { return _mm256_add_ps(a, b); }
+    static inline simd_t SimdSub(simd_t a, simd_t b) { return _mm256_sub_ps(a, b); }
+    static inline simd_t SimdMul(simd_t a, simd_t b) { return _mm256_mul_ps(a, b); }
+    static inline simd_t SimdDiv(simd_t a, simd_t b) { return _mm256_div_ps(a, b); }
+    static inline simd_t SimdMin(simd_t a, simd_t b) { return _mm256_min_ps(a, b); }
+    static inline simd_t SimdMax(simd_t a, simd_t b) { return _mm256_max_ps(a, b); }
+    static inline simd_t SimdLess(simd_t a, simd_t b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static inline simd_t SimdSelect(simd_t mask, simd_t a, simd_t b) { return _mm256_blendv_ps(b, a, mask); }
+#else
+    typedef __m128 simd_t;
+
+    static inline simd_t SimdSet(float f) { return _mm_set1_ps(f); }
+    static inline simd_t SimdLoad(const float* p) { return _mm_loadu_ps(p); }
+    static inline void SimdStore(float* p, simd_t a) { _mm_storeu_ps(p, a); }
+    static inline simd_t SimdAdd(simd_t a, simd_t b) { return _mm_add_ps(a, b); }
+    static inline simd_t SimdSub(simd_t a, simd_t b) { return _mm_sub_ps(a, b); }
+    static inline simd_t SimdMul(simd_t a, simd_t b) { return _mm_mul_ps(a, b); }
+    static inline simd_t SimdDiv(simd_t a, simd_t b) { return _mm_div_ps(a, b); }
+    static inline simd_t SimdMin(simd_t a, simd_t b) { return _mm_min_ps(a, b); }
+    static inline simd_t SimdMax(simd_t a, simd_t b) { return _mm_max_ps(a, b); }
+    static inline simd_t SimdLess(simd_t a, simd_t b) { return _mm_cmplt_ps(a, b); }
+    static inline simd_t SimdSelect(simd_t mask, simd_t a, simd_t b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+#endif
+
+    // GetSquaredDistancePointSegment for one segment per lane, same operation order as the scalar code
+    static inline simd_t SimdSegmentDistance(simd_t px, simd_t py, simd_t s1x, simd_t s1y, simd_t s2x, simd_t s2y)
+    {
+        const simd_t one = SimdSet(1.0f);
+        const simd_t zero = SimdSet(0.0f);
+
+        const simd_t dx = SimdSub(s1x, s2x);
+        const simd_t dy = SimdSub(s1y, s2y);
+        const simd_t l2 = SimdAdd(SimdMul(dx, dx), SimdMul(dy, dy));
+
+        // degenerate segment: distance to S2
+        const simd_t ex = SimdSub(px, s2x);
+        const simd_t ey = SimdSub(py, s2y);
+        const simd_t end_distance = SimdAdd(SimdMul(ex, ex), SimdMul(ey, ey));
+
+        const simd_t psx = SimdSub(px, s1x);
+        const simd_t psy = SimdSub(py, s1y);
+        const simd_t tx = SimdSub(s2x, s1x);
+        const simd_t ty = SimdSub(s2y, s1y);
+
+        // l2 is only used as divisor where it is >= 1, clamp it so masked lanes stay finite
+        const simd_t tf = SimdDiv(SimdAdd(SimdMul(psx, tx), SimdMul(psy, ty)), SimdMax(l2, one));
+        const simd_t t = SimdMax(zero, SimdMin(one, tf));
+
+        const simd_t fx = SimdSub(px, SimdAdd(s1x, SimdMul(tx, t)));
+        const simd_t fy = SimdSub(py, SimdAdd(s1y, SimdMul(ty, t)));
+        const simd_t distance = SimdAdd(SimdMul(fx, fx), SimdMul(fy, fy));
+
+        return SimdSelect(SimdLess(l2, one), end_distance, distance);
+    }
+
+    SegmentHit GetNearestSegment(const ImVec2& point, const SegmentBatch& batch)
+    {
+        const size_t width = NODES_EDIT_SIMD_WIDTH;
+        const size_t blocks = batch.Size() / width;
+
+        SegmentHit hit = { -1, FLT_MAX };
+
+        const simd_t px = SimdSet(point.x);
+        const simd_t py = SimdSet(point.y);
+
+        for (size_t block = 0; block < blocks; ++block)
+        {
+            const size_t first = block * width;
+
+            const simd_t ax = SimdLoad(&batch.ax[first]), ay = SimdLoad(&batch.ay[first]);
+            const simd_t bx = SimdLoad(&batch.bx[first]), by = SimdLoad(&batch.by[first]);
+
+            float lanes[NODES_EDIT_SIMD_WIDTH];
+            SimdStore(lanes, SimdSegmentDistance(px, py, ax, ay, bx, by));
+
+            for (size_t lane = 0; lane < width; ++lane)
+            {
+                if (lanes[lane] < hit.distance_squared)
+                {
+                    hit.owner = batch.owner[first + lane];
+                    hit.distance_squared = lanes[lane];
+                }
+            }
+        }
+
+        // remainder that does not fill a whole register
+        AccumulateScalar(point, batch, blocks * width, hit);
+
+#ifdef NODES_EDIT_CHECK_SIMD
+        const SegmentHit reference = GetNearestSegmentScalar(point, batch);
+        IM_ASSERT(fabsf(reference.distance_squared - hit.distance_squared) <= 1e-3f * ImMax(1.0f, reference.distance_squared));
+#endif
+
+        return hit;
+    }
+
+#else
+
+    SegmentHit GetNearestSegment(const ImVec2& point, const SegmentBatch& batch)
+    {
+        return GetNearestSegmentScalar(point, batch);
+    }
+
+#endif
+}
@@ -0,0 +1,89 @@
+// Bezier flattening and distance queries for the node graph editor
+//
+// A link is flattened once into a polyline with as many segments as its size
+// and bend on screen need, and that polyline is both drawn and picked. Picking
+// tests one point against the segments of every candidate link, stored as
+// structure of arrays, 4 (SSE2) or 8 (AVX) segments per iteration, and is
+// checked against the scalar reference when NODES_EDIT_CHECK_SIMD is defined.
+// Define NODES_EDIT_NO_SIMD to force the scalar path.
+
+#pragma once
+
+#define IMGUI_DEFINE_MATH_OPERATORS
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    inline float GetSquaredDistancePointSegment(const ImVec2& P, const ImVec2& S1, const ImVec2& S2)
+    {
+        const float l2 = (S1.x - S2.x) * (S1.x - S2.x) + (S1.y - S2.y) * (S1.y - S2.y);
+
+        if (l2 < 1.0f)
+        {
+            return (P.x - S2.x) * (P.x - S2.x) + (P.y - S2.y) * (P.y - S2.y);
+        }
+
+        ImVec2 PS1(P.x - S1.x, P.y - S1.y);
+        ImVec2 T(S2.x - S1.x, S2.y - S1.y);
+
+        const float tf = (PS1.x * T.x + PS1.y * T.y) / l2;
+        const float minTf = 1.0f < tf ? 1.0f : tf;
+        const float t = 0.0f > minTf ? 0.0f : minTf;
+
+        T.x = S1.x + T.x * t;
+        T.y = S1.y + T.y * t;
+
+        return (P.x - T.x) * (P.x - T.x) + (P.y - T.y) * (P.y - T.y);
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // segments a uniform flattening of the curve needs to stay within tolerance of it (Wang's formula),
+    // the bound grows with the size and the bend of the control polygon, a straight curve needs one
+    int GetBezierSegmentCount(const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, float tolerance, int max_segments = 64);
+
+    // replaces points with the segments + 1 points of the curve, uniform in t
+    void FlattenBezier(const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4, int segments, std::vector<ImVec2>& points);
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // segments of many polylines, one array per coordinate
+    struct SegmentBatch
+    {
+        std::vector<float> ax, ay, bx, by;
+        std::vector<int> owner;         // caller defined index of the polyline a segment belongs to
+
+        size_t Size() const { return ax.size(); }
+
+        void Clear()
+        {
+            ax.clear(); ay.clear(); bx.clear(); by.clear();
+            owner.clear();
+        }
+
+        void Add(const ImVec2& a, const ImVec2& b, int index)
+        {
+            ax.push_back(a.x); ay.push_back(a.y);
+            bx.push_back(b.x); by.push_back(b.y);
+            owner.push_back(index);
+        }
+    };
+
+    struct SegmentHit
+    {
+        int owner;                  // owner of the nearest segment, -1 if the batch is empty
+        float distance_squared;
+    };
+
+    // reference implementation, one segment at a time
+    SegmentHit GetNearestSegmentScalar(const ImVec2& point, const SegmentBatch& batch);
+
+    // vectorized when available, same result as the scalar version (lowest index wins ties)
+    SegmentHit GetNearestSegment(const ImVec2& point, const SegmentBatch& batch);
+}
@@ -0,0 +1,83 @@
+// Retained geometry for the node graph editor
+
+#include "NodesDrawCache.h"
+
+namespace ImGui
+{
+    NodeDrawCache::NodeDrawCache()
+    {
+        origin_ = ImVec2(0.0f, 0.0f);
+        scale_ = 0.0f;
+        key_ = 0;
+
+        vertex_start_ = 0;
+        index_start_ = 0;
+        command_count_ = 0;
+    }
+
+    void NodeDrawCache::Begin(const ImDrawList* draw_list)
+    {
+        vertex_start_ = draw_list->VtxBuffer.Size;
+        index_start_ = draw_list->IdxBuffer.Size;
+        command_count_ = draw_list->CmdBuffer.Size;
+    }
+
+    bool NodeDrawCache::End(const ImDrawList* draw_list, ImVec2 origin, float scale, uint64_t key)
+    {
+        scale_ = 0.0f;
+
+        if (draw_list->CmdBuffer.Size != command_count_)
+        {
+            return false;
+        }
+
+        // the vectors keep their capacity, recapturing a node costs no allocation
+        vertices_.assign(draw_list->VtxBuffer.Data + vertex_start_, draw_list->VtxBuffer.Data + draw_list->VtxBuffer.Size);
+        indices_.assign(draw_list->IdxBuffer.Data + index_start_, draw_list->IdxBuffer.Data + draw_list->IdxBuffer.Size);
+
+        // indices are absolute in the draw list, the first captured vertex had index _VtxCurrentIdx - count
+        const ImDrawIdx base = (ImDrawIdx)(draw_list->_VtxCurrentIdx - (unsigned int)vertices_.size());
+        for (auto& index : indices_)
+        {
+            index = (ImDrawIdx)(index - base);
+        }
+
+        origin_ = origin;
+        scale_ = scale;
+        key_ = key;
+        return true;
+    }
+
+    void NodeDrawCache::Replay(ImDrawList* draw_list, ImVec2 origin) const
+    {
+        if (vertices_.empty())
+        {
+            return;
+        }
+
+        const ImVec2 delta = origin - origin_;
+
+        // with 16 bit indices PrimReserve may start a new command past 64k vertices and reset
+        // _VtxCurrentIdx, so the first replayed vertex is only known afterwards
+        draw_list->PrimReserve((int)indices_.size(), (int)vertices_.size());
+        const ImDrawIdx base = (ImDrawIdx)draw_list->_VtxCurrentIdx;
+
+        ImDrawVert* vertex = draw_list->_VtxWritePtr;
+        for (const auto& source : vertices_)
+        {
+            *vertex = source;
+            vertex->pos += delta;
+            ++vertex;
+        }
+
+        ImDrawIdx* index = draw_list->_IdxWritePtr;
+        for (const auto source : indices_)
+        {
+            *index++ = (ImDrawIdx)(source + base);
+        }
+
+        draw_list->_VtxWritePtr += vertices_.size();
+        draw_list->_IdxWritePtr += indices_.size();
+        draw_list->_VtxCurrentIdx += (unsigned int)vertices_.size();
+    }
+}
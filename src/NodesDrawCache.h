@@ -0,0 +1,52 @@
+// Retained geometry for the node graph editor
+//
+// A NodeDrawCache keeps the vertices and indices one node or link emitted into
+// the window draw list, in screen space at the canvas offset they were drawn
+// at. As long as the canvas scale and the caller's key are unchanged the
+// geometry can be appended again, moved by the difference in offset, instead
+// of being tessellated again. Panning is a translation, a zoom changes line
+// widths, circle segment counts and glyph sizes, so it empties every cache.
+
+#pragma once
+
+#define IMGUI_DEFINE_MATH_OPERATORS
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    class NodeDrawCache
+    {
+        std::vector<ImDrawVert> vertices_;
+        std::vector<ImDrawIdx> indices_;    // relative to vertices_[0]
+
+        ImVec2 origin_;                     // canvas offset the geometry was captured at
+        float scale_;                       // canvas scale it was captured at, 0 = empty
+        uint64_t key_;                      // caller defined look it was captured with
+
+        // capture in progress
+        int vertex_start_;
+        int index_start_;
+        int command_count_;
+
+    public:
+        NodeDrawCache();
+
+        bool IsValid(float scale, uint64_t key) const { return scale_ == scale && key_ == key; }
+        void Invalidate() { scale_ = 0.0f; }
+
+        // everything drawn between Begin and End is kept, End fails and leaves the cache
+        // empty if the draw list started another command in between (clip rect or texture change)
+        void Begin(const ImDrawList* draw_list);
+        bool End(const ImDrawList* draw_list, ImVec2 origin, float scale, uint64_t key);
+
+        // appends the kept geometry moved from the captured origin to this one
+        void Replay(ImDrawList* draw_list, ImVec2 origin) const;
+    };
+}
@@ -11,9 +11,26 @@
 
 namespace ImGui
 {
-    NodeEditor::NodeEditor()
+    NodeEditor::NodeEditor() : search_(GetNodeTypes())
 	{
 		id_ = 0;
+        select_query_ = 0;
+        visible_frame_ = 0;
+        profiler_visible_ = false;
+        retained_ = true;
+        retained_scale_ = 0.0f;
+        retained_replayed_ = 0;
+        retained_drawn_ = 0;
+        detail_ = NodeDetail_Full;
+        detail_flat_ = 7.0f;
+        detail_bundled_ = 4.5f;
+        order_holes_ = 0;
+        order_visit_ = 0;
+        drag_delta_ = ImVec2(0.0f, 0.0f);
+        search_text_[0] = '\0';
+        search_max_ = 12;
+        search_cursor_ = 0;
+        search_focus_ = false;
         cur_node_.Reset();
 		canvas_scale_ = 1.0f;
 	}
@@ -24,156 +41,764 @@ namespace ImGui
 
     NodeEditor::Node* NodeEditor::GetHoverNode(ImVec2 offset, ImVec2 pos)
 	{
-		for (auto& node : nodes_)
+		Node* hovered = nullptr;
+
+		ImRect query(pos, pos);
+		query.Expand(2.0f);
+
+		node_grid_.Query(ScreenToCanvas(query, offset), [&](Node* node)
 		{
-			ImRect rect((node->position_ * canvas_scale_) + offset, ((node->position_ + node->size_) * canvas_scale_) + offset);
+			const ImRect hit = GetHitRect(*node);
+			ImRect rect((hit.Min * canvas_scale_) + offset, (hit.Max * canvas_scale_) + offset);
 
 			rect.Expand(2.0f);
-			
-			if (rect.Contains(pos))
+
+			// prefer the oldest node, like a front to back scan of nodes_ would
+			if (rect.Contains(pos) && (!hovered || node->id_ < hovered->id_))
 			{
-				return node->Get();
+				hovered = node;
 			}
-		}
+		});
 
-		return nullptr;
+		return hovered;
 	}
 
-    void NodeEditor::RenderLines(ImDrawList* draw_list, ImVec2 offset)
-	{
+    void NodeEditor::GetLinkEndpoints(const NodePadLink& link, ImVec2& p1, ImVec2& p4) const
+    {
+        // ends inside a folded group are drawn at its pads, a folded group always shows them
+        const NodePad* source = GetShownPad(link.source);
+        const NodePad* sink = GetShownPad(link.sink);
+
+        // source
+        if ( source->owner->state_ > 0 || source->owner->group_ ) // we are connected from a not collapsed source node
+        {
+            p1 = source->owner->position_ + source->position_out;
+        }
+        else //we are connected from a collapsed node
+        {
+            p1 = source->owner->position_ + ImVec2(source->owner->size_.x, source->owner->size_.y / 2.0f);
+        }
+
+        // sink
+        if ( sink->owner->state_ > 0 || sink->owner->group_ ) // we are connected to a not collapsed source node
+        {
+            p4 = sink->owner->position_ + sink->position;
+        }
+        else //we are connected to a collapsed node
+        {
+            p4 = sink->owner->position_ + ImVec2(sink->owner->size_.x, sink->owner->size_.y / 2.0f);
+        }
+    }
 
-        for (auto& link : node_links)
+    void NodeEditor::UpdateLinkBounds(NodePadLink& link)
+    {
+        if (IsLinkHidden(link))
         {
-            ImVec2 p1 = offset;
-            ImVec2 p4 = offset;
+            link_grid_.Remove(&link);
+            return;
+        }
+
+        ImVec2 p1, p4;
+        GetLinkEndpoints(link, p1, p4);
 
-            // source
-            if ( link->source->owner->state_ > 0 ) // we are connected from a not collapsed source node
+        // a bezier never leaves the hull of its control points
+        link.hull_ = ImRect(p1, p1);
+        link.hull_.Add(p1 + ImVec2(+50.0f, 0.0f));
+        link.hull_.Add(p4 + ImVec2(-50.0f, 0.0f));
+        link.hull_.Add(p4);
+
+        link_grid_.Update(&link, link.hull_);
+    }
+
+    // flattened once for a segment count that keeps it within half a pixel of the curve on screen,
+    // again only when a node moves or the zoom drifts far enough to make it visibly coarse or wastefully fine
+    const std::vector<ImVec2>& NodeEditor::GetLinkPolyline(NodePadLink& link)
+    {
+        const uint64_t key = GetLinkKey(link);
+        const float drift = canvas_scale_ / ImMax(link.polyline_scale_, 1e-6f);
+
+        if (key == link.polyline_key_ && drift > (1.0f / 1.5f) && drift < 1.5f)
+        {
+            return link.polyline_;
+        }
+
+        ImVec2 p1, p4;
+        GetLinkEndpoints(link, p1, p4);
+
+        // default bezier control points
+        const ImVec2 p2 = p1 + ImVec2(+50.0f, 0.0f);
+        const ImVec2 p3 = p4 + ImVec2(-50.0f, 0.0f);
+
+        FlattenBezier(p1, p2, p3, p4, GetBezierSegmentCount(p1, p2, p3, p4, 0.5f / canvas_scale_), link.polyline_);
+
+        link.polyline_key_ = key;
+        link.polyline_scale_ = canvas_scale_;
+        return link.polyline_;
+    }
+
+    const std::vector<ImVec2>& NodeEditor::GetLinkScreenPolyline(NodePadLink& link, ImVec2 offset)
+    {
+        const std::vector<ImVec2>& polyline = GetLinkPolyline(link);
+
+        link_points_.resize(polyline.size());
+        for (size_t i = 0; i < polyline.size(); ++i)
+        {
+            link_points_[i] = offset + (polyline[i] * canvas_scale_);
+        }
+
+        return link_points_;
+    }
+
+    float NodeEditor::GetSquaredDistanceToLink(NodePadLink& link, ImVec2 point, ImVec2 offset)
+    {
+        const std::vector<ImVec2>& points = GetLinkScreenPolyline(link, offset);
+
+        float distance_squared = FLT_MAX;
+        for (size_t i = 1; i < points.size(); ++i)
+        {
+            distance_squared = ImMin(distance_squared, GetSquaredDistancePointSegment(point, points[i - 1], points[i]));
+        }
+
+        return distance_squared;
+    }
+
+    void NodeEditor::UpdateNodeBounds(Node& node)
+    {
+        // out of the grids inside a folded group, UpdateGroupTree puts it back
+        if (node.hidden_)
+        {
+            return;
+        }
+
+        node_grid_.Update(&node, GetNodeRect(node));
+        node.revision_++;
+
+        if (node.parent_)
+        {
+            MarkFrameDirty(*node.parent_);
+        }
+
+        // only the links attached to this node have to follow, those of a folded group through its member pads
+        for (auto& pad : node.pads)
+        {
+            for (auto link : GetInnerPad(pad)->links_out)
+            {
+                UpdateLinkBounds(*link);
+            }
+
+            for (auto link : GetInnerPad(pad)->links_in)
             {
-                p1 += ((link->source->owner->position_ + link->source->position_out) * canvas_scale_);
+                UpdateLinkBounds(*link);
             }
-            else //we are connected from a collapsed node
+        }
+    }
+
+    void NodeEditor::RenderLines(ImDrawList* draw_list, ImVec2 offset)
+	{
+        // link under the mouse, only links whose hull is within the pick radius get the exact test
+        if (cur_node_.state_ == NodeState_Default)
+        {
+            hover_batch_.Clear();
+            hover_links_.clear();
+
+            ImRect query(ImGui::GetIO().MousePos, ImGui::GetIO().MousePos);
+            query.Expand(10.0f);
+
+            link_grid_.Query(ScreenToCanvas(query, offset), [&](NodePadLink* link)
             {
-                p1 += ((link->source->owner->position_ + ImVec2(link->source->owner->size_.x, link->source->owner->size_.y / 2.0f)) * canvas_scale_);
+                // the same polyline that is drawn, segments that cannot be within the pick radius are left out
+                const std::vector<ImVec2>& points = GetLinkScreenPolyline(*link, offset);
+
+                for (size_t i = 1; i < points.size(); ++i)
+                {
+                    ImRect segment(points[i - 1], points[i - 1]);
+                    segment.Add(points[i]);
+
+                    if (segment.Overlaps(query))
+                    {
+                        hover_batch_.Add(points[i - 1], points[i], (int)hover_links_.size());
+                    }
+                }
+
+                hover_links_.push_back(link);
+            });
+
+            const SegmentHit hit = GetNearestSegment(ImGui::GetIO().MousePos, hover_batch_);
+
+            if (hit.owner >= 0 && hit.distance_squared < (10.0f * 10.0f))
+            {
+                NodePadLink* hovered = hover_links_[hit.owner];
+
+                cur_node_.Reset(NodeState_HoverConnection);
+
+                cur_node_.rect_ = ImRect
+                (
+                    (GetShownPad(hovered->sink)->owner->position_ + GetShownPad(hovered->sink)->position),
+                    (GetShownPad(hovered->source)->owner->position_ + GetShownPad(hovered->source)->position_out)
+                );
+
+                // dragging the link drags the node it is drawn from
+                cur_node_.node_ = GetShownPad(hovered->source)->owner->Get();
+                cur_node_.selected_pad = hovered->source->Get();
+                cur_node_.link = hovered;
             }
+        }
+
+        // only links whose hull touches the viewport are tessellated
+        ImRect visible = GetVisibleCanvasRect();
+        visible.Expand(4.0f);
 
-            // sink
-            if ( link->sink->owner->state_ > 0 ) // we are connected to a not collapsed source node
+        if (detail_ == NodeDetail_Bundled)
+        {
+            RenderBundles(draw_list, offset, visible);
+            return;
+        }
+
+        const bool capture = retained_ && canvas_scale_ == retained_scale_;
+
+        link_grid_.Query(visible, [&](NodePadLink* link)
+        {
+            bool selected = false;
+            selected |= cur_node_.state_ == NodeState_SelectedConnection;
+            selected |= cur_node_.state_ == NodeState_DraggingConnection;
+            selected &= cur_node_.selected_pad == link->source->Get();
+
+            // a link only changes shape with one of its nodes, the selected one is never cached
+            const uint64_t look = GetLinkKey(*link);
+
+            if (retained_ && !selected && link->draw_cache_.IsValid(canvas_scale_, look))
             {
-                p4 += ((link->sink->owner->position_ + link->sink->position) * canvas_scale_);
+                link->draw_cache_.Replay(draw_list, offset);
+                retained_replayed_++;
+                return;
             }
-            else //we are connected to a collapsed node
+
+            const std::vector<ImVec2>& points = GetLinkScreenPolyline(*link, offset);
+
+            if (capture && !selected)
             {
-                p4 += ((link->sink->owner->position_ + ImVec2(link->sink->owner->size_.x, link->sink->owner->size_.y / 2.0f)) * canvas_scale_);
+                link->draw_cache_.Begin(draw_list);
             }
 
-            // default bezier control points
-            ImVec2 p2 = p1 + (ImVec2(+50.0f, 0.0f) * canvas_scale_);
-            ImVec2 p3 = p4 + (ImVec2(-50.0f, 0.0f) * canvas_scale_);
+            draw_list->AddPolyline(points.data(), (int)points.size(), ImColor(0.5f, 0.5f, 0.5f, 1.0f), false, 2.0f * canvas_scale_);
 
-            // what does this do? probably link selection???
-            if (cur_node_.state_ == NodeState_Default)
+            if (capture && !selected)
             {
-                const float distance_squared = GetSquaredDistanceToBezierCurve(ImGui::GetIO().MousePos, p1, p2, p3, p4);
+                link->draw_cache_.End(draw_list, offset, canvas_scale_, look);
+            }
 
-                if (distance_squared < (10.0f * 10.0f))
-                {
-                    cur_node_.Reset(NodeState_HoverConnection);
-
-                    cur_node_.rect_ = ImRect
-                    (
-                        (link->sink->owner->position_ + link->sink->position),
-                        //(connection->target_->position_ + connection->input_->position_),
-                        (link->source->owner->position_ + link->source->position_out)
-                        //(node->position_ + connection->position_)
-                    );
-
-                    cur_node_.node_ = link->source->owner->Get();
-                    cur_node_.selected_pad = link->source->Get();
-                    cur_node_.link = link;
-                }
+            if (selected)
+            {
+                draw_list->AddPolyline(points.data(), (int)points.size(), ImColor(0.f, 1.0f, 0.f, 0.25f), false, 4.0f * canvas_scale_);
             }
 
+            retained_drawn_++;
+        });
+	}
+
+    // far out links are straight lines, the links that start and end in the same few pixels are drawn
+    // once and a little thicker, so a dense patch costs as many lines as there are distinct paths on screen
+    void NodeEditor::RenderBundles(ImDrawList* draw_list, ImVec2 offset, const ImRect& visible)
+    {
+        const float cell = 3.0f;
+
+        // cells move with the canvas so bundles do not shimmer while panning
+        const ImVec2 anchor(fmodf(offset.x, cell), fmodf(offset.y, cell));
+
+        auto pack = [cell, anchor](ImVec2 p) -> uint64_t
+        {
+            const float x = ImClamp(floorf((p.x - anchor.x) / cell) + 32768.0f, 0.0f, 65535.0f);
+            const float y = ImClamp(floorf((p.y - anchor.y) / cell) + 32768.0f, 0.0f, 65535.0f);
+            return ((uint64_t)x << 16) | (uint64_t)y;
+        };
+
+        auto unpack = [cell, anchor](uint64_t key) -> ImVec2
+        {
+            return anchor + ImVec2(((float)((key >> 16) & 0xffff) - 32768.0f + 0.5f) * cell, ((float)(key & 0xffff) - 32768.0f + 0.5f) * cell);
+        };
+
+        bundles_.clear();
+        link_grid_.Query(visible, [&](NodePadLink* link)
+        {
+            ImVec2 p1, p4;
+            GetLinkEndpoints(*link, p1, p4);
+
+            p1 = offset + (p1 * canvas_scale_);
+            p4 = offset + (p4 * canvas_scale_);
+
             bool selected = false;
             selected |= cur_node_.state_ == NodeState_SelectedConnection;
             selected |= cur_node_.state_ == NodeState_DraggingConnection;
             selected &= cur_node_.selected_pad == link->source->Get();
 
-            draw_list->AddBezierCurve(p1, p2, p3, p4, ImColor(0.5f, 0.5f, 0.5f, 1.0f), 2.0f * canvas_scale_);
-
             if (selected)
             {
-                draw_list->AddBezierCurve(p1, p2, p3, p4, ImColor(0.f, 1.0f, 0.f, 0.25f), 4.0f * canvas_scale_);
+                draw_list->AddLine(p1, p4, ImColor(0.f, 1.0f, 0.f, 0.25f), 4.0f * canvas_scale_);
             }
+
+            bundles_.push_back((pack(p1) << 32) | pack(p4));
+        });
+
+        std::sort(bundles_.begin(), bundles_.end());
+
+        for (size_t i = 0; i < bundles_.size();)
+        {
+            size_t end = i + 1;
+            while (end < bundles_.size() && bundles_[end] == bundles_[i])
+            {
+                end++;
+            }
+
+            const float thickness = ImMin(1.0f + 0.5f * log2f((float)(end - i)), 3.0f);
+            draw_list->AddLine(unpack(bundles_[i] >> 32), unpack(bundles_[i] & 0xffffffff), ImColor(0.5f, 0.5f, 0.5f, 1.0f), thickness);
+
+            retained_drawn_++;
+            i = end;
         }
-	}
+    }
 
     void NodeEditor::DisplayNodes(ImDrawList* drawList, ImVec2 offset)
 	{
 		ImGui::SetWindowFontScale(canvas_scale_);
 
-		for (auto& node : nodes_)
+        // tag the nodes touched by the selection rect once instead of testing every node
+        if (cur_node_.state_ == NodeState_SelectingEmpty || cur_node_.state_ == NodeState_SelectingValid || cur_node_.state_ == NodeState_SelectingMore)
+        {
+            const uint32_t query = ++select_query_;
+            node_grid_.Query(ScreenToCanvas(cur_node_.rect_, offset), [query](Node* node)
+            {
+                node->select_query_ = query;
+            });
+        }
+
+        // the selection only outlives the states that use it as the rubber band rebuilds it
+        if (!IsSelectingState())
+        {
+            selection_.Clear();
+        }
+
+        // fully off-screen nodes get no ImGui items and no geometry, pads hang a little over the node border
+        ImRect visible = GetVisibleCanvasRect();
+        visible.Expand(16.0f);
+
+        const uint32_t frame = ++visible_frame_;
+        visible_nodes_.clear();
+        node_grid_.Query(visible, [&](Node* node)
+        {
+            node->visible_frame_ = frame;
+            visible_nodes_.push_back(node);
+        });
+
+        // keep the creation order of nodes_ so overlapping nodes stack the same way,
+        // open groups go first, outermost first, to be drawn behind their members
+        std::sort(visible_nodes_.begin(), visible_nodes_.end(), [](const Node* a, const Node* b)
+        {
+            const uint32_t layer_a = IsOpenGroup(*a) ? a->depth_ : UINT32_MAX;
+            const uint32_t layer_b = IsOpenGroup(*b) ? b->depth_ : UINT32_MAX;
+
+            return layer_a != layer_b ? layer_a < layer_b : a->id_ < b->id_;
+        });
+
+		for (auto node : visible_nodes_)
 		{
 			DisplayNode(drawList, offset, *node);
 		}			
 
+        // hover targets that scrolled out of view are not tracked by DisplayNode anymore
+        if ((cur_node_.state_ == NodeState_HoverNode || cur_node_.state_ == NodeState_HoverIO) && cur_node_.node_ && cur_node_.node_->visible_frame_ != frame)
+        {
+            cur_node_.Reset();
+        }
+
+        // neither are pads once they are no longer drawn
+        if (cur_node_.state_ == NodeState_HoverIO && detail_ != NodeDetail_Full)
+        {
+            cur_node_.Reset();
+        }
+
 		ImGui::SetWindowFontScale(1.0f);
 	}
 
-    void NodeEditor::AddNodePadLink(NodePad *source, NodePad *sink)
+    // indexes a node that has its pads, position and size, and hands it to the callbacks
+    void NodeEditor::AttachNode(Node* node)
+    {
+        node->group_ = node->type_ == node_group_type_;
+        UpdateNodeBounds(*node);
+
+        // a node without links can go anywhere, the end keeps every existing order
+        node->order_ = (uint32_t)order_.size();
+        order_.push_back(node);
+
+        node_ids_[node->id_] = node;
+        node->index_ = nodes_.size();
+        nodes_.push_back(node);
+
+        // groups only exist in the editor
+        if (!node->group_)
+        {
+            NodeAdded(*node);
+        }
+    }
+
+    NodeEditor::Node* NodeEditor::FindNode(int32_t id) const
+    {
+        auto found = node_ids_.find(id);
+        return found != node_ids_.end() ? found->second : nullptr;
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // a link source -> sink closes a cycle when sink already reaches source;
+    // only nodes ordered between the two can be on such a path
+    bool NodeEditor::WouldCreateCycle(Node* source, Node* sink)
+    {
+        if (source == sink)
+        {
+            return true;
+        }
+
+        if (sink->order_ > source->order_)
+        {
+            return false;
+        }
+
+        const uint32_t upper = source->order_;
+        const uint32_t visit = ++order_visit_;
+
+        order_forward_.clear();
+        order_stack_.clear();
+        order_stack_.push_back(sink);
+        sink->order_visit_ = visit;
+
+        while (!order_stack_.empty())
+        {
+            Node* node = order_stack_.back();
+            order_stack_.pop_back();
+            order_forward_.push_back(node);
+
+            for (NodePad* pad : node->pads)
+            {
+                for (NodePadLink* link : pad->links_out)
+                {
+                    Node* next = link->sink->owner;
+                    if (next == source)
+                    {
+                        return true;
+                    }
+
+                    if (next->order_visit_ != visit && next->order_ < upper)
+                    {
+                        next->order_visit_ = visit;
+                        order_stack_.push_back(next);
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    // Pearce-Kelly: only the nodes between sink and source in the current order are visited and renumbered
+    bool NodeEditor::AddLinkOrder(Node* source, Node* sink)
+    {
+        const uint32_t lower = sink->order_;
+
+        // fills order_forward_ with everything sink reaches below source
+        if (WouldCreateCycle(source, sink))
+        {
+            return false;
+        }
+
+        if (lower > source->order_)
+        {
+            return true;
+        }
+
+        // everything above sink that reaches source
+        const uint32_t visit = order_visit_;
+        order_backward_.clear();
+        order_stack_.clear();
+        order_stack_.push_back(source);
+        source->order_visit_ = visit;
+
+        while (!order_stack_.empty())
+        {
+            Node* node = order_stack_.back();
+            order_stack_.pop_back();
+            order_backward_.push_back(node);
+
+            for (NodePad* pad : node->pads)
+            {
+                for (NodePadLink* link : pad->links_in)
+                {
+                    Node* prev = link->source->owner;
+                    if (prev->order_visit_ != visit && prev->order_ > lower)
+                    {
+                        prev->order_visit_ = visit;
+                        order_stack_.push_back(prev);
+                    }
+                }
+            }
+        }
+
+        // hand the same positions back out: the backward set first, then the forward set, each in its old order
+        auto by_order = [](const Node* a, const Node* b) { return a->order_ < b->order_; };
+        std::sort(order_backward_.begin(), order_backward_.end(), by_order);
+        std::sort(order_forward_.begin(), order_forward_.end(), by_order);
+
+        order_slots_.clear();
+        for (Node* node : order_backward_) order_slots_.push_back(node->order_);
+        for (Node* node : order_forward_) order_slots_.push_back(node->order_);
+        std::sort(order_slots_.begin(), order_slots_.end());
+
+        size_t slot = 0;
+        for (Node* node : order_backward_) node->order_ = order_slots_[slot++];
+        for (Node* node : order_forward_) node->order_ = order_slots_[slot++];
+
+        for (Node* node : order_backward_) order_[node->order_] = node;
+        for (Node* node : order_forward_) order_[node->order_] = node;
+
+        return true;
+    }
+
+    void NodeEditor::RemoveNodeOrder(Node* node)
+    {
+        order_[node->order_] = nullptr;
+        ++order_holes_;
+
+        // compact once most of the order is holes, relative order is kept
+        if (order_holes_ > 64 && order_holes_ * 2 > order_.size())
+        {
+            size_t used = 0;
+            for (Node* entry : order_)
+            {
+                if (entry)
+                {
+                    entry->order_ = (uint32_t)used;
+                    order_[used++] = entry;
+                }
+            }
+            order_.resize(used);
+            order_holes_ = 0;
+        }
+    }
+
+    // for bulk relinking, one Kahn pass over the whole graph instead of a Pearce-Kelly step per link;
+    // returns how many nodes are on or behind a cycle, they are left at the end in their previous order
+    size_t NodeEditor::RebuildOrder()
+    {
+        order_forward_.clear();
+        for (Node* node : order_)
+        {
+            if (node)
+            {
+                node->order_ = (uint32_t)order_forward_.size();
+                order_forward_.push_back(node);
+            }
+        }
+
+        // incoming link count per node, indexed by the compacted order
+        order_slots_.assign(order_forward_.size(), 0);
+        for (Node* node : order_forward_)
+        {
+            for (NodePad* pad : node->pads)
+            {
+                order_slots_[node->order_] += (uint32_t)pad->links_in.size();
+            }
+        }
+
+        order_stack_.clear();
+        for (Node* node : order_forward_)
+        {
+            if (order_slots_[node->order_] == 0)
+            {
+                order_stack_.push_back(node);
+            }
+        }
+
+        // order_stack_ is used as a queue, sources keep their previous relative order
+        for (size_t head = 0; head < order_stack_.size(); ++head)
+        {
+            for (NodePad* pad : order_stack_[head]->pads)
+            {
+                for (NodePadLink* link : pad->links_out)
+                {
+                    Node* next = link->sink->owner;
+                    if (--order_slots_[next->order_] == 0)
+                    {
+                        order_stack_.push_back(next);
+                    }
+                }
+            }
+        }
+
+        // every node still needs a slot of its own, or later updates would write over other nodes
+        const size_t cyclic = order_forward_.size() - order_stack_.size();
+        if (cyclic)
+        {
+            for (Node* node : order_forward_)
+            {
+                if (order_slots_[node->order_] > 0)
+                {
+                    order_stack_.push_back(node);
+                }
+            }
+        }
+
+        order_.swap(order_stack_);
+        order_holes_ = 0;
+
+        for (size_t i = 0; i < order_.size(); ++i)
+        {
+            order_[i]->order_ = (uint32_t)i;
+        }
+
+        return cyclic;
+    }
+
+    void NodeEditor::GetTopologicalOrder(std::vector<Node*>& order) const
+    {
+        order.clear();
+        order.reserve(order_.size() - order_holes_);
+
+        for (Node* node : order_)
+        {
+            if (node)
+            {
+                order.push_back(node);
+            }
+        }
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // returns nullptr, and adds nothing, when the link would close a cycle
+    NodeEditor::NodePadLink* NodeEditor::AddNodePadLink(NodePad *source, NodePad *sink)
+    {
+        if (!AddLinkOrder(source->owner, sink->owner))
+        {
+            return nullptr;
+        }
+
+        return AttachLink(source, sink);
+    }
+
+    // links two pads without touching order_, the caller knows the graph stays acyclic
+    NodeEditor::NodePadLink* NodeEditor::AttachLink(NodePad *source, NodePad *sink)
     {
-        auto link = new NodePadLink();
+        auto link = link_pool_.Create();
         link->source = source;
         link->sink = sink;
         link->source->connections_++;
         link->sink->connections_++;
+        link->source->owner->revision_++; // connected pads are drawn filled
+        link->sink->owner->revision_++;
+        link->polyline_scale_ = 0.0f;
+        UpdateLinkBounds(*link);
+
+        // the proxies of a folded group are made from the links of its members
+        if (source->owner->hidden_ || sink->owner->hidden_)
+        {
+            MarkGroupDirty(*source->owner);
+            MarkGroupDirty(*sink->owner);
+        }
+
+        link->index_ = node_links.size();
+        link->source_slot_ = source->links_out.size();
+        link->sink_slot_ = sink->links_in.size();
+
         this->node_links.push_back(link);
+        source->links_out.push_back(link);
+        sink->links_in.push_back(link);
 
         //****
         // Call subscribe as a source is connected to a sink
         //****
         LinkAdded(link->source, link->sink);
+        return link;
     }
 
     void NodeEditor::DeleteNodePadLink(NodePadLink* link) {
-        this->node_links.erase(
-                std::remove(node_links.begin(), node_links.end(), link),
-                node_links.end());
+        // swap and pop from every list the link is stored in
+        NodePadLink* moved = node_links.back();
+        node_links[link->index_] = moved;
+        moved->index_ = link->index_;
+        node_links.pop_back();
+
+        auto& links_out = link->source->links_out;
+        moved = links_out.back();
+        links_out[link->source_slot_] = moved;
+        moved->source_slot_ = link->source_slot_;
+        links_out.pop_back();
+
+        auto& links_in = link->sink->links_in;
+        moved = links_in.back();
+        links_in[link->sink_slot_] = moved;
+        moved->sink_slot_ = link->sink_slot_;
+        links_in.pop_back();
+
+        link_grid_.Remove(link);
+
+        if (link->source->owner->hidden_ || link->sink->owner->hidden_)
+        {
+            MarkGroupDirty(*link->source->owner);
+            MarkGroupDirty(*link->sink->owner);
+        }
+
         LinkDeleted(link->source, link->sink);
         link->source->connections_--;
         link->sink->connections_--;
-        delete link;
+        link->source->owner->revision_++;
+        link->sink->owner->revision_++;
+        link_pool_.Destroy(link);
     }
 
     void NodeEditor::DeleteSelectedNodes() {
-        std::vector<std::unique_ptr<Node>> replacement;
-        replacement.reserve(nodes_.size());
+        // a selected group goes with everything inside it
+        std::vector<Node*> delete_nodes;
+        GetSelectedNodes(delete_nodes);
+
+        DeleteNodes(delete_nodes);
+        selection_.Clear();
+    }
+
+    // a group has to come with everything inside it, the rest of the selection is kept
+    void NodeEditor::DeleteNodes(const std::vector<Node*>& delete_nodes)
+    {
+        std::vector<int32_t> ids;
+        ids.reserve(delete_nodes.size());
+        for (const Node* node : delete_nodes)
+        {
+            ids.push_back(node->id_);
+        }
+        std::sort(ids.begin(), ids.end());
+
+        auto deleted = [&ids](const Node* node) { return std::binary_search(ids.begin(), ids.end(), node->id_); };
 
         std::vector<NodePadLink*> delete_links;
-        delete_links.reserve(node_links.size());
         // delete connections
-        // todo iterate the nodepadlink vector instead of nodes vector???
-        for (auto& node : nodes_)
+        for (Node* node : delete_nodes)
         {
-            if ( node->id_ > 0 ) {
-                replacement.push_back(std::move(node));
-                continue;  // node not selected
-            }
+            node_grid_.Remove(node);
 
-            int connections = 0;
-            for (auto& pad : node->pads)
+            // a member leaves a group that stays
+            if (node->parent_ && !deleted(node->parent_))
             {
-                connections += pad->connections_;
+                SetParent(*node, nullptr);
             }
-            if ( connections == 0 ) continue; // no links to this node
 
-            for (auto& link : node_links)
+            for (auto& pad : node->pads)
             {
-                if ( link->source->owner == node.get() ||
-                     link->sink->owner == node.get() )
+                //mark this node's connections for deletion
+                delete_links.insert(delete_links.end(), pad->links_out.begin(), pad->links_out.end());
+
+                for (auto link : pad->links_in)
                 {
-                    //mark this connection for deletion
-                    delete_links.push_back(link);
+                    // links between two deleted nodes are already taken from the source side
+                    if (!deleted(link->source->owner))
+                    {
+                        delete_links.push_back(link);
+                    }
                 }
             }
         }
@@ -182,83 +807,243 @@ namespace ImGui
             DeleteNodePadLink(link);
         }
 
-        // save not selected nodes
-        nodes_ = std::move(replacement);
+        for (auto& node : delete_nodes)
+        {
+            RemoveNode(node);
+            DestroyNode(node);
+        }
+    }
+
+    // swap and pop from nodes_, the draw order comes from the ids
+    void NodeEditor::RemoveNode(Node* node)
+    {
+        Node* moved = nodes_.back();
+        nodes_[node->index_] = moved;
+        moved->index_ = node->index_;
+        nodes_.pop_back();
+    }
+
+    void NodeEditor::DestroyNode(Node* node)
+    {
+        if (!node->group_)
+        {
+            NodeDeleted(*node);
+        }
+
+        RemoveNodeOrder(node);
+        node_ids_.erase(node->id_);
+        selection_.Remove(node->id_);
+
+        // proxies are let go by their member pads first, the members may be destroyed after the group
+        if (node->group_)
+        {
+            ClearProxies(*node);
+        }
+
+        for (auto& pad : node->pads)
+        {
+            // the group showing it is rebuilt by UpdateGroups
+            if (pad->proxy)
+            {
+                pad->proxy->inner = nullptr;
+            }
+
+            pad_pool_.Destroy(pad);
+        }
+
+        node_pool_.Destroy(node);
+    }
+
+    void NodeEditor::ClearGraph()
+    {
+        // bulk reset: no per object frees, the pools keep their chunks for the next graph
+        nodes_.clear();
+        node_links.clear();
+        visible_nodes_.clear();
+        order_.clear();
+        order_holes_ = 0;
+        node_ids_.clear();
+        history_.Clear();
+        dirty_groups_.clear();
+        dirty_frames_.clear();
+
+        node_grid_.Clear();
+        link_grid_.Clear();
+
+        link_pool_.Clear();
+        pad_pool_.Clear();
+        node_pool_.Clear();
+
+        cur_node_.Reset();
+        selection_.Clear();
+
+        GraphCleared();
     }
 
     NodeEditor::Node* NodeEditor::CreateNodeFromType(ImVec2 pos, const NodeType& type)
 	{
-		auto node = std::make_unique<Node>();
+		std::vector<Node*> created;
+		CreateNodesFromType(type, std::vector<ImVec2>(1, pos), created);
 
-		////////////////////////////////////////////////////////////////////////////////
-		
-		node->id_ = -++id_;
-        node->name_ = type.name + std::to_string(id_).c_str();
-		node->position_ = pos;
+		selection_.Add(created[0]->id_);
+		return created[0];
+	}
 
-		{
-            std::vector<NodePadType>::const_iterator it = type.pads.begin();
-            while (it != type.pads.end())
+    void NodeEditor::CreateNodesFromType(const NodeType& type, const std::vector<ImVec2>& positions, std::vector<Node*>& created)
+    {
+        node_pool_.Reserve(positions.size());
+        pad_pool_.Reserve(positions.size() * type.pads.size());
+        nodes_.reserve(nodes_.size() + positions.size());
+        order_.reserve(order_.size() + positions.size());
+        node_ids_.reserve(node_ids_.size() + positions.size());
+
+        created.clear();
+        created.reserve(positions.size());
+
+        // the pads of a type are the same on every node, the first one is measured for all
+        const Node* model = nullptr;
+
+        for (const ImVec2& pos : positions)
+        {
+            auto node = node_pool_.Create();
+
+            node->id_ = ++id_;
+            node->name_ = type.name + std::to_string(id_);
+            node->type_ = type.name;
+            node->position_ = pos;
+
+            CreateNodePads(*node, type.pads);
+
+            LayoutNode(*node, model);
+            node->position_ -= node->size_ / 2.0f;
+
+            AttachNode(node);
+            created.push_back(node);
+
+            if (!model)
             {
-                auto pad = std::make_unique<NodePad>();
-                pad->name = it->name;
-                pad->access = it->access;
-                pad->format = it->format;
-                pad->owner = node.get();
-                node->pads.push_back(std::move(pad));
-                ++it;
+                model = node;
             }
-		}
+        }
+    }
+
+    void NodeEditor::SelectAll()
+    {
+        for (auto& node : nodes_)
+        {
+            selection_.Add(node->id_);
+        }
+
+        cur_node_.Reset(NodeState_Selected);
+    }
+
+    void NodeEditor::CreateNodePads(Node& node, const std::vector<NodePadType>& types)
+    {
+        node.pads.reserve(node.pads.size() + types.size());
+        std::vector<NodePadType>::const_iterator it = types.begin();
+        while (it != types.end())
+        {
+            auto pad = pad_pool_.Create();
+            pad->name = it->name;
+            pad->access = it->access;
+            pad->format = it->format;
+            pad->access_flags = ParseNodePadAccess(it->access);
+            pad->format_id = GetNodeFormats().Intern(it->format);
+            pad->owner = &node;
+            node.pads.push_back(pad);
+            ++it;
+        }
+    }
 
+    // with a model whose pads have the same names, their measured sizes are reused
+    void NodeEditor::LayoutNode(Node& node, const Node* model)
+	{
 		////////////////////////////////////////////////////////////////////////////////
 
-		ImVec2 title_size = ImGui::CalcTextSize(node->name_.c_str());
+		// every string is measured once, the results are kept until the first draw remeasures them at canvas scale
+		node.title_size_ = ImGui::CalcTextSize(node.name_.c_str());
+		node.text_scale_ = -1.0f;
+
+		const ImVec2 title_size = node.title_size_;
 
         const float vertical_padding = 1.5f;
 
 		////////////////////////////////////////////////////////////////////////////////
 
+        const bool same_pads = model && model->pads.size() == node.pads.size();
+
         ImVec2 pads_size;
-        for (auto& pad : node->pads)
+        for (size_t i = 0; i < node.pads.size(); ++i)
 		{
-            ImVec2 name_size = ImGui::CalcTextSize(pad->name.c_str());
+            NodePad* pad = node.pads[i];
+
+            if (same_pads && model->pads[i]->name == pad->name)
+            {
+                pad->name_size_ = model->pads[i]->name_size_;
+            }
+            else
+            {
+                pad->name_size_ = ImGui::CalcTextSize(pad->name.c_str());
+            }
+
+            const ImVec2 name_size = pad->name_size_;
             pads_size.x = ImMax(pads_size.x, name_size.x);
             pads_size.y += name_size.y * vertical_padding;
 		}
 
 		////////////////////////////////////////////////////////////////////////////////
 
-        node->size_.x = ImMax(pads_size.x, title_size.x);
-		node->size_.x += title_size.y * 6.0f;
+        node.size_.x = ImMax(pads_size.x, title_size.x);
+		node.size_.x += title_size.y * 6.0f;
 
-		node->collapsed_height = (title_size.y * 2.0f);
-        node->full_height = (title_size.y * 3.0f) + pads_size.y;
+		node.collapsed_height = (title_size.y * 2.0f);
+        node.full_height = (title_size.y * 3.0f) + pads_size.y;
 
-		node->size_.y = node->full_height;
-		
-		node->position_ -= node->size_ / 2.0f;
+		node.size_.y = node.full_height;
 		
 		////////////////////////////////////////////////////////////////////////////////
 
         // we place node connection sockets on the border of the node widget with an offset of 2px
         pads_size = ImVec2(2, title_size.y * 2.5f);
-        for (auto& pad : node->pads)
+        for (auto& pad : node.pads)
 		{
             //input pads
-            const float half = ((ImGui::CalcTextSize(pad->name.c_str()).y * vertical_padding) / 2.0f);
+            const float half = ((pad->name_size_.y * vertical_padding) / 2.0f);
 
             pads_size.y += half;
             pad->position = ImVec2(pads_size.x, pads_size.y);
-            pad->position_out = ImVec2(pads_size.x + node->size_.x, pads_size.y);
+            pad->position_out = ImVec2(pads_size.x + node.size_.x, pads_size.y);
             pads_size.y += half;
 		}
 	
 		////////////////////////////////////////////////////////////////////////////////
-
-		nodes_.push_back(std::move(node));
-		return nodes_.back().get();
 	}
 
+    void NodeEditor::UpdateTextLayout(Node& node)
+    {
+        // the window font scale follows canvas_scale_, so text only needs measuring again after a zoom
+        if (node.text_scale_ == canvas_scale_)
+        {
+            return;
+        }
+
+        node.title_size_ = ImGui::CalcTextSize(node.name_.c_str());
+
+        for (auto& pad : node.pads)
+        {
+            pad->name_size_ = ImGui::CalcTextSize(pad->name.c_str());
+        }
+
+        node.text_scale_ = canvas_scale_;
+    }
+
+    void NodeEditor::RenameNode(Node& node, const std::string& name)
+    {
+        node.name_ = name;
+        node.text_scale_ = -1.0f;
+        node.revision_++;
+    }
+
     void NodeEditor::UpdateScroll()
 	{
 		////////////////////////////////////////////////////////////////////////////////
@@ -340,16 +1125,8 @@ namespace ImGui
         // collapsing nodes
         if (cur_node_.state_ == NodeState_HoverNode && ImGui::IsMouseDoubleClicked(0))
 		{		
-            if (cur_node_.node_->state_ < 0)
-			{	// collapsed node goes to full
-                cur_node_.node_->size_.y = cur_node_.node_->full_height;
-			}
-			else
-			{	// full node goes to collapsed
-                cur_node_.node_->size_.y = cur_node_.node_->collapsed_height;
-			}
-
-            cur_node_.node_->state_ = -cur_node_.node_->state_;
+            ToggleCollapsed(*cur_node_.node_);
+            RecordCollapse(*cur_node_.node_);
 		}
 
         switch (cur_node_.state_)
@@ -381,14 +1158,7 @@ namespace ImGui
 
             case NodeState_HoverConnection:
 			{
-				const float distance_squared = GetSquaredDistanceToBezierCurve
-				(
-					ImGui::GetIO().MousePos,
-                    offset + (cur_node_.rect_.Min * canvas_scale_),
-                    offset + (cur_node_.rect_.Min * canvas_scale_) + (ImVec2(+50.0f, 0.0f) * canvas_scale_),
-                    offset + (cur_node_.rect_.Max * canvas_scale_) + (ImVec2(-50.0f, 0.0f) * canvas_scale_),
-                    offset + (cur_node_.rect_.Max * canvas_scale_)
-				);
+				const float distance_squared = GetSquaredDistanceToLink(*cur_node_.link, ImGui::GetIO().MousePos, offset);
 				
 				if (distance_squared > (10.0f * 10.0f))
 				{
@@ -507,7 +1277,7 @@ namespace ImGui
 					break;
 				}
 
-				for (auto& node : nodes_)
+				node_grid_.Query(ScreenToCanvas(cur_node_.rect_, offset), [&](Node* node)
 				{
 					ImVec2 node_rect_min = offset + (node->position_ * canvas_scale_);
 					ImVec2 node_rect_max = node_rect_min + (node->size_ * canvas_scale_);
@@ -516,16 +1286,16 @@ namespace ImGui
 
                     if (ImGui::GetIO().KeyCtrl && cur_node_.rect_.Overlaps(node_rect))
 					{
-						node->id_ = -abs(node->id_); // add "selected" flag
-						continue;
+						selection_.Add(node->id_);
+						return;
 					}
 					
                     if (!ImGui::GetIO().KeyCtrl && cur_node_.rect_.Contains(node_rect))
 					{
-						node->id_ = -abs(node->id_); // add "selected" flag
-						continue;
+						selection_.Add(node->id_);
+						return;
 					}
-				}
+				});
 
                 cur_node_.Reset(NodeState_Selected);
 			} break;
@@ -535,6 +1305,7 @@ namespace ImGui
 				// delete all selected nodes
 				if (ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_Delete]))
 				{
+                    RecordDeleteSelected();
                     DeleteSelectedNodes();
                     cur_node_.Reset();
 					break;
@@ -570,7 +1341,7 @@ namespace ImGui
 				// lets select node under the mouse
 				if (ImGui::GetIO().KeyShift)
 				{
-					hovered->id_ = -abs(hovered->id_);
+					selection_.Add(hovered->id_);
                     cur_node_.state_ = NodeState_DraggingSelected;
 					break;
 				}
@@ -578,40 +1349,37 @@ namespace ImGui
 				// lets toggle selection of a node under the mouse
 				if (!ImGui::GetIO().KeyShift && ImGui::GetIO().KeyCtrl)
 				{
-					if (hovered->id_ > 0)
+					if (selection_.Add(hovered->id_))
 					{
-						hovered->id_ = -abs(hovered->id_);
                         cur_node_.state_ = NodeState_DraggingSelected;
 					}
 					else
 					{
-						hovered->id_ = abs(hovered->id_);
+						selection_.Remove(hovered->id_);
                         cur_node_.state_ = NodeState_Selected;
 					}
 					break;
 				}
 
 				// lets start dragging
-				if (hovered->id_ < 0)
+				if (selection_.Contains(hovered->id_))
 				{
                     cur_node_.state_ = NodeState_DraggingSelected;
 					break;
 				}
 				
 				// not selected node clicked, lets jump selection to it
-				for (auto& node : nodes_)
-				{
-					if (node.get() != hovered)
-					{
-						node->id_ = abs(node->id_);
-					}
-				}
+				selection_.Clear();
 			} break;
 
             case NodeState_DraggingSelected:
 			{
 				if (!ImGui::IsMouseDown(0))
 				{
+                    // the whole drag is one step, every selected node moved by the same amount
+                    RecordMove(selection_.GetIds(), drag_delta_);
+                    drag_delta_ = ImVec2(0.0f, 0.0f);
+
                     if (cur_node_.node_)
 					{
 						if (ImGui::GetIO().KeyShift || ImGui::GetIO().KeyCtrl)
@@ -629,13 +1397,16 @@ namespace ImGui
 				}
 				else
 				{
-					for (auto& node : nodes_)
+					for (int32_t id : selection_)
 					{
-						if (node->id_ < 0)
+						// a selected group already moves its members
+						Node* node = FindNode(id);
+						if (!HasSelectedAncestor(*node))
 						{
-							node->position_ += ImGui::GetIO().MouseDelta / canvas_scale_;
+							OffsetNode(*node, ImGui::GetIO().MouseDelta / canvas_scale_);
 						}
 					}
+                    drag_delta_ += ImGui::GetIO().MouseDelta / canvas_scale_;
 				}
 			} break;
 
@@ -649,14 +1420,7 @@ namespace ImGui
 
 				if (ImGui::IsMouseDown(0))
 				{
-					const float distance_squared = GetSquaredDistanceToBezierCurve
-					(
-						ImGui::GetIO().MousePos,
-                        offset + (cur_node_.rect_.Min * canvas_scale_),
-                        offset + (cur_node_.rect_.Min * canvas_scale_) + (ImVec2(+50.0f, 0.0f) * canvas_scale_),
-                        offset + (cur_node_.rect_.Max * canvas_scale_) + (ImVec2(-50.0f, 0.0f) * canvas_scale_),
-                        offset + (cur_node_.rect_.Max * canvas_scale_)
-					);
+					const float distance_squared = GetSquaredDistanceToLink(*cur_node_.link, ImGui::GetIO().MousePos, offset);
 
 					if (distance_squared > (10.0f * 10.0f))
 					{
@@ -670,7 +1434,7 @@ namespace ImGui
                 if (ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_Delete]))
                 {
                     // delete selected connection
-                    // first fins the link index
+                    RecordLink(NodeHistory_LinkDelete, *cur_node_.link);
                     this->DeleteNodePadLink(cur_node_.link);
                     cur_node_.Reset(NodeState_Default);
                 }
@@ -678,6 +1442,12 @@ namespace ImGui
 
             case NodeState_DraggingConnection:
 			{
+				if (!ImGui::IsMouseDown(0) || ImGui::IsMouseClicked(1))
+				{
+                    RecordMove(std::vector<int32_t>(1, cur_node_.node_->id_), drag_delta_);
+                    drag_delta_ = ImVec2(0.0f, 0.0f);
+				}
+
 				if (!ImGui::IsMouseDown(0))
 				{
                     cur_node_.state_ = NodeState_SelectedConnection;
@@ -690,7 +1460,8 @@ namespace ImGui
 					break;
 				}
 
-                cur_node_.node_->position_ += ImGui::GetIO().MouseDelta / canvas_scale_;
+                OffsetNode(*cur_node_.node_, ImGui::GetIO().MouseDelta / canvas_scale_);
+                drag_delta_ += ImGui::GetIO().MouseDelta / canvas_scale_;
                 // todo: only used to draw a bezier using mouse pos so don't do this in the struct?
                 //cur_node_.selected_pad->target_->position_ += ImGui::GetIO().MouseDelta / canvas_scale_;
 			} break;
@@ -699,14 +1470,14 @@ namespace ImGui
 
     void NodeEditor::DisplayNode(ImDrawList* drawList, ImVec2 offset, Node& node)
 	{
-		ImGui::PushID(abs(node.id_));
+		ImGui::PushID(node.id_);
 		ImGui::BeginGroup();
 
         ImVec2 node_rect_min = offset + (node.position_ * canvas_scale_);
 		ImVec2 node_rect_max = node_rect_min + (node.size_ * canvas_scale_);
 
 		ImGui::SetCursorScreenPos(node_rect_min);
-		ImGui::InvisibleButton("Node", node.size_ * canvas_scale_);
+		ImGui::InvisibleButton("Node", GetHitRect(node).GetSize() * canvas_scale_);
 		
 		////////////////////////////////////////////////////////////////////////////////
 
@@ -721,7 +1492,7 @@ namespace ImGui
 
 				if (node_active)
 				{
-					node.id_ = -abs(node.id_); // add "selected" flag
+					selection_.Add(node.id_);
                     cur_node_.state_ = NodeState_DraggingSelected;
 				}
 			}
@@ -732,7 +1503,7 @@ namespace ImGui
 
 				if (node_active)
 				{
-					node.id_ = -abs(node.id_); // add "selected" flag
+					selection_.Add(node.id_);
                     cur_node_.state_ = NodeState_DraggingSelected;
 				}
 				else
@@ -756,19 +1527,12 @@ namespace ImGui
 
 		////////////////////////////////////////////////////////////////////////////////
 
-        if (cur_node_.state_ != NodeState_Selected && cur_node_.state_ != NodeState_DraggingSelected && cur_node_.state_ != NodeState_SelectingMore)
-		{
-			node.id_ = abs(node.id_); // remove "selected" flag
-		}
-
-		////////////////////////////////////////////////////////////////////////////////
-
 		bool consider_select = false;
         consider_select |= cur_node_.state_ == NodeState_SelectingEmpty;
         consider_select |= cur_node_.state_ == NodeState_SelectingValid;
         consider_select |= cur_node_.state_ == NodeState_SelectingMore;
 
-		if (consider_select)
+		if (consider_select && node.select_query_ == select_query_) // only nodes reported by the grid query in DisplayNodes
 		{		
 			bool select_it = false;
 		
@@ -787,16 +1551,88 @@ namespace ImGui
 
             if (select_it && cur_node_.state_ != NodeState_SelectingMore)
 			{
-				node.id_ = -abs(node.id_); // add "selected" flag
+				selection_.Add(node.id_);
                 cur_node_.state_ = NodeState_SelectingValid;
 			}
 		}
 
 		////////////////////////////////////////////////////////////////////////////////
 
-		ImVec2 title_name_size = ImGui::CalcTextSize(node.name_.c_str());
+		////////////////////////////////////////////////////////////////////////////////
+
+		// retained mode: a node that is not hovered, not the target of the current action and not
+		// near the mouse is replayed as long as its look is unchanged, a pad drag recolors every node
+		const bool highlighted = (consider_select && consider_hover) || selection_.Contains(node.id_);
+		const uint64_t look = ((uint64_t)node.revision_ << 4) | ((uint64_t)detail_ << 2) | (node.state_ > 0 ? 1 : 0) | (highlighted ? 2 : 0);
+
+		bool quiet = retained_ && cur_node_.node_ != node.Get() && !IsDraggingPadState();
+		if (quiet)
+		{
+			ImRect reach(node_rect_min, node_rect_max);
+			reach.Expand(node.title_size_.y); // pads hang over the border
+
+			quiet = !reach.Contains(ImGui::GetIO().MousePos);
+		}
+
+		if (quiet && node.draw_cache_.IsValid(canvas_scale_, look))
+		{
+			node.draw_cache_.Replay(drawList, offset);
+			retained_replayed_++;
+
+			ImGui::EndGroup();
+			ImGui::PopID();
+			return;
+		}
+
+		// text is clipped on the CPU, only nodes fully inside the canvas can be replayed elsewhere
+		const bool capture = quiet && canvas_scale_ == retained_scale_ &&
+			ImRect(drawList->GetClipRectMin(), drawList->GetClipRectMax()).Contains(ImRect(node_rect_min, node_rect_max));
+
+		if (capture)
+		{
+			node.draw_cache_.Begin(drawList);
+		}
+
+		retained_drawn_++;
+
+		if (IsOpenGroup(node))
+		{
+			DisplayGroupFrame(drawList, node, node_rect_min, node_rect_max, highlighted);
+
+			if (capture)
+			{
+				node.draw_cache_.End(drawList, offset, canvas_scale_, look);
+			}
+
+			ImGui::EndGroup();
+			ImGui::PopID();
+			return;
+		}
+
+		if (detail_ != NodeDetail_Full)
+		{
+			DisplayNodeFlat(drawList, node, node_rect_min, node_rect_max, highlighted);
+
+			if (capture)
+			{
+				node.draw_cache_.End(drawList, offset, canvas_scale_, look);
+			}
+
+			ImGui::EndGroup();
+			ImGui::PopID();
+			return;
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+
+		UpdateTextLayout(node);
+
+		const ImVec2 title_name_size = node.title_size_;
 		const float corner = title_name_size.y / 2.0f;
 
+		// a folded group shows its pads
+		const bool expanded = node.state_ > 0 || node.group_;
+
 		{		
 			ImVec2 title_area;
 			title_area.x = node_rect_max.x;
@@ -805,7 +1641,7 @@ namespace ImGui
 			ImVec2 title_pos;
 			title_pos.x = node_rect_min.x + ((title_area.x - node_rect_min.x) / 2.0f) - (title_name_size.x / 2.0f);
 			
-			if (node.state_ > 0)
+			if (expanded)
 			{
 				drawList->AddRectFilled(node_rect_min, node_rect_max, ImColor(0.25f, 0.25f, 0.25f, 0.9f), corner, ImDrawCornerFlags_All);
 				drawList->AddRectFilled(node_rect_min, title_area, ImColor(0.25f, 0.0f, 0.125f, 0.9f), corner, ImDrawCornerFlags_Top);
@@ -825,20 +1661,22 @@ namespace ImGui
 
 		////////////////////////////////////////////////////////////////////////////////
 		
-		if (node.state_ > 0)
+		if (expanded)
 		{
 			////////////////////////////////////////////////////////////////////////////////
 
+            const NodeFormatTable& formats = GetNodeFormats();
+
             for (auto& pad : node.pads)
 			{
-                if (pad->format.empty() ) // if empty string
+                if (pad->format_id == NodeFormat_None) // if empty string
 				{
 					continue;
 				}
 
 				bool consider_io = false;
 
-                ImVec2 input_name_size = ImGui::CalcTextSize(pad->name.c_str());
+                const ImVec2 input_name_size = pad->name_size_;
                 ImVec2 pad_pos = node_rect_min + (pad->position * canvas_scale_);
 
                 {
@@ -849,7 +1687,7 @@ namespace ImGui
                     ImGui::Text("%s", pad->name.c_str());
                 }
 
-                if ( pad->access.find('w') != std::string::npos ) // string contains 'r'
+                if ( pad->access_flags & NodePadAccess_Write ) // input pad
                 {
                     // TODO: rename to pad...
                     float pad_radius = input_name_size.y/2.f;
@@ -864,12 +1702,12 @@ namespace ImGui
                         {
                             cur_node_.Reset(NodeState_HoverIO);
                             cur_node_.node_ = node.Get();
-                            cur_node_.selected_pad = pad.get();
+                            cur_node_.selected_pad = pad;
                             cur_node_.position_ = node.position_ + pad->position;
                         }
 
                         // we could start Dragging input now
-                        if (ImGui::IsMouseClicked(0) && cur_node_.selected_pad == pad.get())
+                        if (ImGui::IsMouseClicked(0) && cur_node_.selected_pad == pad)
                         {
                             cur_node_.state_ = NodeState_DraggingInput;
 
@@ -888,7 +1726,7 @@ namespace ImGui
 
                         consider_io = true;
                     }
-                    else if (cur_node_.state_ == NodeState_HoverIO && cur_node_.selected_pad == pad.get())
+                    else if (cur_node_.state_ == NodeState_HoverIO && cur_node_.selected_pad == pad)
                     {
                         cur_node_.Reset(); // we are not hovering this last hovered input anymore
                     }
@@ -906,22 +1744,32 @@ namespace ImGui
                     if (cur_node_.state_ == NodeState_DraggingOutput || cur_node_.state_ == NodeState_DraggingOutputValid)
                     {
                         // check is dragging output are not from the same node
-                        if (cur_node_.node_ != node.Get() && cur_node_.selected_pad->format.compare(pad->format) == 0 )
+                        if (cur_node_.node_ != node.Get() && formats.IsCompatible(cur_node_.selected_pad->format_id, pad->format_id))
                         {
                             color = ImColor(0.0f, 1.0f, 0.0f, 1.0f);
 
-                            if (consider_io)
+                            // only the hovered pad is tested, a link that closes a cycle is refused
+                            if (consider_io && WouldCreateCycle(GetInnerPad(cur_node_.selected_pad)->owner, GetInnerPad(pad)->owner))
+                            {
+                                color = ImColor(1.0f, 0.0f, 0.0f, 1.0f);
+                                drawList->AddCircleFilled(pad_pos, (input_name_size.y / 3.0f), color);
+                            }
+                            else if (consider_io)
                             {
                                 cur_node_.state_ = NodeState_DraggingOutputValid;
                                 drawList->AddCircleFilled(pad_pos, (input_name_size.y / 3.0f), color);
 
                                 if (!ImGui::IsMouseDown(0))
                                 {
-                                    AddNodePadLink(cur_node_.selected_pad->Get(), pad.get());
+                                    // a group pad links its member pad
+                                    if (NodePadLink* link = AddNodePadLink(GetInnerPad(cur_node_.selected_pad), GetInnerPad(pad)))
+                                    {
+                                        RecordLink(NodeHistory_LinkAdd, *link);
+                                    }
 
                                     cur_node_.Reset(NodeState_HoverIO);
                                     cur_node_.node_ = node.Get();
-                                    cur_node_.selected_pad = pad.get();
+                                    cur_node_.selected_pad = pad;
                                     cur_node_.position_ = node_rect_min + pad->position;
                                 }
                             }
@@ -931,7 +1779,7 @@ namespace ImGui
                     consider_io |= cur_node_.state_ == NodeState_HoverIO;
                     consider_io |= cur_node_.state_ == NodeState_DraggingInput;
                     consider_io |= cur_node_.state_ == NodeState_DraggingInputValid;
-                    consider_io &= cur_node_.selected_pad == pad.get();
+                    consider_io &= cur_node_.selected_pad == pad;
 
                     if (consider_io)
                     {
@@ -946,7 +1794,7 @@ namespace ImGui
                     drawList->AddCircle(pad_pos, (input_name_size.y / 3.0f), color, ((int)(6.0f * canvas_scale_) + 10), (1.5f * canvas_scale_));
                 }
 
-                if ( pad->access.find_first_of('r') != std::string::npos ) // string contains 'w'
+                if ( pad->access_flags & NodePadAccess_Read ) // output pad
                 {
                     ImVec2 pad_output_pos = pad_pos;
                     pad_output_pos.x += (node.size_.x-4) * canvas_scale_; //position with 2px inward correction
@@ -962,20 +1810,20 @@ namespace ImGui
                         {
                             cur_node_.Reset(NodeState_HoverIO);
                             cur_node_.node_ = node.Get();
-                            cur_node_.selected_pad = pad.get();
+                            cur_node_.selected_pad = pad;
                             cur_node_.position_ = node.position_ + pad->position;
                             cur_node_.position_.x += node.size_.x-4; // we need to set the output pad position
                         }
 
                         // we could start dragging output now
-                        if (ImGui::IsMouseClicked(0) && cur_node_.selected_pad == pad.get())
+                        if (ImGui::IsMouseClicked(0) && cur_node_.selected_pad == pad)
                         {
                             cur_node_.state_ = NodeState_DraggingOutput;
                         }
 
                         consider_io = true;
                     }
-                    else if (cur_node_.state_ == NodeState_HoverIO && cur_node_.selected_pad == pad.get())
+                    else if (cur_node_.state_ == NodeState_HoverIO && cur_node_.selected_pad == pad)
                     {
                         cur_node_.Reset(); // we are not hovering this last hovered output anymore
                     }
@@ -993,22 +1841,30 @@ namespace ImGui
                     if (cur_node_.state_ == NodeState_DraggingInput || cur_node_.state_ == NodeState_DraggingInputValid)
                     {
                         // check is dragging input are not from the same node
-                        if (cur_node_.node_ != node.Get() && cur_node_.selected_pad->format.compare(pad->format) == 0)
+                        if (cur_node_.node_ != node.Get() && formats.IsCompatible(pad->format_id, cur_node_.selected_pad->format_id))
                         {
                             color = ImColor(0.0f, 1.0f, 0.0f, 1.0f);
 
-                            if (consider_io)
+                            if (consider_io && WouldCreateCycle(GetInnerPad(pad)->owner, GetInnerPad(cur_node_.selected_pad)->owner))
+                            {
+                                color = ImColor(1.0f, 0.0f, 0.0f, 1.0f);
+                                drawList->AddCircleFilled(pad_output_pos, (input_name_size.y / 3.0f), color);
+                            }
+                            else if (consider_io)
                             {
                                 cur_node_.state_ = NodeState_DraggingInputValid;
                                 drawList->AddCircleFilled(pad_output_pos, (input_name_size.y / 3.0f), color);
                                 // if mouse released create a new NodeLink
                                 if (!ImGui::IsMouseDown(0))
                                 {
-                                    AddNodePadLink(pad.get(), cur_node_.selected_pad->Get());
+                                    if (NodePadLink* link = AddNodePadLink(GetInnerPad(pad), GetInnerPad(cur_node_.selected_pad)))
+                                    {
+                                        RecordLink(NodeHistory_LinkAdd, *link);
+                                    }
 
                                     cur_node_.Reset(NodeState_HoverIO);
                                     cur_node_.node_ = node.Get();
-                                    cur_node_.selected_pad = pad.get();
+                                    cur_node_.selected_pad = pad;
                                     cur_node_.position_ = node_rect_min + pad->position;
                                 }
                             }
@@ -1018,7 +1874,7 @@ namespace ImGui
                     consider_io |= cur_node_.state_ == NodeState_HoverIO;
                     consider_io |= cur_node_.state_ == NodeState_DraggingOutput;
                     consider_io |= cur_node_.state_ == NodeState_DraggingOutputValid;
-                    consider_io &= cur_node_.selected_pad == pad.get();
+                    consider_io &= cur_node_.selected_pad == pad;
 
                     if (consider_io)
                     {
@@ -1055,19 +1911,75 @@ namespace ImGui
 
 		////////////////////////////////////////////////////////////////////////////////
 
-		if ((consider_select && consider_hover) || (node.id_ < 0))
+		if (highlighted)
 		{
 			drawList->AddRectFilled(node_rect_min, node_rect_max, ImColor(1.0f, 1.0f, 1.0f, 0.25f), corner, ImDrawCornerFlags_All);
 		}
 
+		if (capture)
+		{
+			node.draw_cache_.End(drawList, offset, canvas_scale_, look);
+		}
+
 		ImGui::EndGroup();
 		ImGui::PopID();
 	}
 
+    // below full detail text would be a few pixels high, the node is one or two quads and its pads are not drawn
+    void NodeEditor::DisplayNodeFlat(ImDrawList* drawList, const Node& node, ImVec2 node_rect_min, ImVec2 node_rect_max, bool highlighted)
+    {
+        if ((node.state_ > 0 || node.group_) && detail_ == NodeDetail_Flat)
+        {
+            const ImVec2 title_area(node_rect_max.x, node_rect_min.y + (node.collapsed_height * canvas_scale_));
+
+            drawList->AddRectFilled(node_rect_min, node_rect_max, ImColor(0.25f, 0.25f, 0.25f, 0.9f));
+            drawList->AddRectFilled(node_rect_min, title_area, ImColor(0.25f, 0.0f, 0.125f, 0.9f));
+        }
+        else
+        {
+            drawList->AddRectFilled(node_rect_min, node_rect_max, ImColor(0.25f, 0.0f, 0.125f, 0.9f));
+        }
+
+        if (highlighted)
+        {
+            drawList->AddRectFilled(node_rect_min, node_rect_max, ImColor(1.0f, 1.0f, 1.0f, 0.25f));
+        }
+    }
+
+    static const char* GetNodeStateName(uint32_t state)
+    {
+        static const char* names[] =
+        {
+            "NodeState_Default",
+            "NodeState_Block",
+            "NodeState_HoverIO",
+            "NodeState_HoverConnection",
+            "NodeState_HoverNode",
+            "NodeState_DraggingInput",
+            "NodeState_DraggingInputValid",
+            "NodeState_DraggingOutput",
+            "NodeState_DraggingOutputValid",
+            "NodeState_DraggingConnection",
+            "NodeState_DraggingSelected",
+            "NodeState_SelectingEmpty",
+            "NodeState_SelectingValid",
+            "NodeState_SelectingMore",
+            "NodeState_Selected",
+            "NodeState_SelectedConnection"
+        };
+
+        return state < (uint32_t)IM_ARRAYSIZE(names) ? names[state] : "UNKNOWN";
+    }
+
     void NodeEditor::ProcessNodes()
 	{
 		////////////////////////////////////////////////////////////////////////////////
-		
+
+        profiler_.BeginFrame();
+
+        retained_replayed_ = 0;
+        retained_drawn_ = 0;
+
         ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(1, 1));
         ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
         ImGui::PushStyleColor(ImGuiCol_ChildBg, ImVec4(0.2f, 0.2f, 0.2f, 1.0f));
@@ -1078,13 +1990,61 @@ namespace ImGui
 
 		////////////////////////////////////////////////////////////////////////////////
 
+        // the viewport is needed for culling even while the window is not focused
+        canvas_position_ = ImGui::GetCursorScreenPos();
+        canvas_size_ = ImGui::GetWindowSize();
+
 		if (ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows))
 		{
 			canvas_mouse_ = ImGui::GetIO().MousePos - ImGui::GetCursorScreenPos();
-			canvas_position_ = ImGui::GetCursorScreenPos();
-			canvas_size_ = ImGui::GetWindowSize();
 
 			UpdateScroll();
+
+            // undo / redo, select all and the clipboard, not in the middle of a drag or a connection edit
+            if (ImGui::GetIO().KeyCtrl && (cur_node_.state_ == NodeState_Default || cur_node_.state_ == NodeState_Selected))
+            {
+                if (ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_A]))
+                {
+                    SelectAll();
+                }
+
+                if (ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_C]))
+                {
+                    CopySelection();
+                }
+                else if (ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_V]))
+                {
+                    PasteClipboard((canvas_mouse_ - canvas_scroll_) / canvas_scale_);
+                }
+                // there is no ImGuiKey for D, backends index KeysDown by key code
+                else if (ImGui::IsKeyPressed('D') || ImGui::IsKeyPressed('d'))
+                {
+                    DuplicateSelection();
+                }
+                // nor for G, shift takes the selected groups apart
+                else if (ImGui::IsKeyPressed('G') || ImGui::IsKeyPressed('g'))
+                {
+                    if (ImGui::GetIO().KeyShift)
+                    {
+                        UngroupSelection();
+                    }
+                    else
+                    {
+                        GroupSelection();
+                    }
+                }
+
+                const bool redo = ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_Y]) || (ImGui::GetIO().KeyShift && ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_Z]));
+
+                if (redo)
+                {
+                    Redo();
+                }
+                else if (ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_Z]))
+                {
+                    Undo();
+                }
+            }
 		}
 		
 		////////////////////////////////////////////////////////////////////////////////
@@ -1092,6 +2052,8 @@ namespace ImGui
 		{
 			ImDrawList* draw_list = ImGui::GetWindowDrawList();
 
+			profiler_.Begin(NodeProfilePhase_Grid, draw_list);
+
 			ImU32 color = ImColor(0.5f, 0.5f, 0.5f, 0.1f);
 			const float size = 64.0f * canvas_scale_;
 
@@ -1104,15 +2066,30 @@ namespace ImGui
 			{
 				draw_list->AddLine(ImVec2(0.0f, y) + canvas_position_, ImVec2(canvas_size_.x, y) + canvas_position_, color);
 			}
+
+			profiler_.End(NodeProfilePhase_Grid);
 		}
 
 		////////////////////////////////////////////////////////////////////////////////
 
 		ImVec2 offset = canvas_position_ + canvas_scroll_;
 
+        // the window font scale is still 1 here
+        const float text_height = ImGui::GetFontSize() * canvas_scale_;
+        detail_ = text_height < detail_bundled_ ? NodeDetail_Bundled : text_height < detail_flat_ ? NodeDetail_Flat : NodeDetail_Full;
+
+		profiler_.Begin(NodeProfilePhase_UpdateState, draw_list);
 		UpdateState(offset);
+		UpdateGroups();
+		profiler_.End(NodeProfilePhase_UpdateState);
+
+		profiler_.Begin(NodeProfilePhase_RenderLines, draw_list);
 		RenderLines(draw_list, offset);
+		profiler_.End(NodeProfilePhase_RenderLines);
+
+		profiler_.Begin(NodeProfilePhase_DisplayNodes, draw_list);
 		DisplayNodes(draw_list, offset);
+		profiler_.End(NodeProfilePhase_DisplayNodes);
 
         if (cur_node_.state_ == NodeState_SelectingEmpty || cur_node_.state_ == NodeState_SelectingValid || cur_node_.state_ == NodeState_SelectingMore)
 		{
@@ -1123,6 +2100,8 @@ namespace ImGui
 		////////////////////////////////////////////////////////////////////////////////
 		
 		{
+			profiler_.Begin(NodeProfilePhase_ContextMenu, draw_list);
+
 			ImGui::SetCursorScreenPos(canvas_position_);
 
 			bool consider_menu = !ImGui::IsAnyItemHovered();
@@ -1137,6 +2116,11 @@ namespace ImGui
 				if (context->IO.MouseDragMaxDistanceSqr[1] < 36.0f)
 				{
 					ImGui::OpenPopup("NodesContextMenu");
+
+					search_text_[0] = '\0';
+					search_cursor_ = 0;
+					search_focus_ = true;
+					search_.Query(search_text_, search_max_, search_results_);
 				}								
 			}
 
@@ -1145,58 +2129,81 @@ namespace ImGui
 			{
                 cur_node_.Reset(NodeState_Block);
 
-                for (auto& node : node_types)
+                // type to search, only the best matches are laid out; arrows and enter pick one
+                if (search_focus_)
+                {
+                    ImGui::SetKeyboardFocusHere();
+                    search_focus_ = false;
+                }
+
+                if (ImGui::InputText("##NodesSearch", search_text_, sizeof(search_text_)))
+                {
+                    search_.Query(search_text_, search_max_, search_results_);
+                    search_cursor_ = 0;
+                }
+
+                const int count = (int)search_results_.size();
+                if (count)
+                {
+                    if (ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_DownArrow]))
+                    {
+                        search_cursor_ = (search_cursor_ + 1) % count;
+                    }
+                    if (ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_UpArrow]))
+                    {
+                        search_cursor_ = (search_cursor_ + count - 1) % count;
+                    }
+                }
+
+                const bool enter = ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_Enter]);
+                const NodeType* picked = nullptr;
+
+                for (int i = 0; i < count; ++i)
 				{
-                    if (ImGui::MenuItem(node.name.c_str()))
-					{					
-                        cur_node_.Reset();
-                        cur_node_.node_ = CreateNodeFromType((canvas_mouse_ - canvas_scroll_) / canvas_scale_, node);
+                    if (ImGui::Selectable(search_results_[i]->name.c_str(), i == search_cursor_) || (enter && i == search_cursor_))
+					{
+                        picked = search_results_[i];
 					}
-				}				
+				}
+
+                if (!count)
+                {
+                    ImGui::TextDisabled("no matching type");
+                }
+
+                if (picked)
+                {
+                    cur_node_.Reset();
+                    cur_node_.node_ = CreateNodeFromType((canvas_mouse_ - canvas_scroll_) / canvas_scale_, *picked);
+                    RecordCreate(std::vector<Node*>(1, cur_node_.node_));
+                    ImGui::CloseCurrentPopup();
+                }
+                else if (ImGui::IsKeyPressed(ImGui::GetIO().KeyMap[ImGuiKey_Escape]))
+                {
+                    ImGui::CloseCurrentPopup();
+                }
+
 				ImGui::EndPopup();
 			}
 			ImGui::PopStyleVar();
+
+			profiler_.End(NodeProfilePhase_ContextMenu);
 		}
 
 		////////////////////////////////////////////////////////////////////////////////
 
-        {
-            ImGui::SetCursorScreenPos(canvas_position_);
-
-            switch (cur_node_.state_)
-            {
-                case NodeState_Default: ImGui::Text("NodeState_Default"); break;
-                case NodeState_Block: ImGui::Text("NodeState_Block"); break;
-                case NodeState_HoverIO: ImGui::Text("NodeState_HoverIO"); break;
-                case NodeState_HoverConnection: ImGui::Text("NodeState_HoverConnection"); break;
-                case NodeState_HoverNode: ImGui::Text("NodeState_HoverNode"); break;
-                case NodeState_DraggingInput: ImGui::Text("NodeState_DraggingInput"); break;
-                case NodeState_DraggingInputValid: ImGui::Text("NodeState_DraggingInputValid"); break;
-                case NodeState_DraggingOutput: ImGui::Text("NodeState_DraggingOutput"); break;
-                case NodeState_DraggingOutputValid: ImGui::Text("NodeState_DraggingOutputValid"); break;
-                case NodeState_DraggingConnection: ImGui::Text("NodeState_DraggingConnection"); break;
-                case NodeState_DraggingSelected: ImGui::Text("NodeState_DraggingSelected"); break;
-                case NodeState_SelectingEmpty: ImGui::Text("NodeState_SelectingEmpty"); break;
-                case NodeState_SelectingValid: ImGui::Text("NodeState_SelectingValid"); break;
-                case NodeState_SelectingMore: ImGui::Text("NodeState_SelectingMore"); break;
-                case NodeState_Selected: ImGui::Text("NodeState_Selected"); break;
-                case NodeState_SelectedConnection: ImGui::Text("NodeState_SelectedConnection"); break;
-                default: ImGui::Text("UNKNOWN"); break;
-            }
+        profiler_.EndFrame();
 
-            ImGui::Text("");
+        retained_scale_ = canvas_scale_;
 
-            ImGui::Text("Mouse: %.2f, %.2f", ImGui::GetIO().MousePos.x, ImGui::GetIO().MousePos.y);
-            ImGui::Text("Mouse delta: %.2f, %.2f", ImGui::GetIO().MouseDelta.x, ImGui::GetIO().MouseDelta.y);
-            ImGui::Text("Offset: %.2f, %.2f", offset.x, offset.y);
+        if (profiler_visible_)
+        {
+            ImGui::SetCursorScreenPos(canvas_position_);
 
-            ImGui::Text("");
+            static const char* details[] = { "full", "flat", "bundled" };
 
-            ImGui::Text("Canvas_mouse: %.2f, %.2f", canvas_mouse_.x, canvas_mouse_.y);
-            ImGui::Text("Canvas_position: %.2f, %.2f", canvas_position_.x, canvas_position_.y);
-            ImGui::Text("Canvas_size: %.2f, %.2f", canvas_size_.x, canvas_size_.y);
-            ImGui::Text("Canvas_scroll: %.2f, %.2f", canvas_scroll_.x, canvas_scroll_.y);
-            ImGui::Text("Canvas_scale: %.2f", canvas_scale_);
+            ImGui::Text("%s  nodes %d  links %d  scale %.2f  detail %s  replayed %u  drawn %u", GetNodeStateName(cur_node_.state_), (int)nodes_.size(), (int)node_links.size(), canvas_scale_, details[detail_], retained_replayed_, retained_drawn_);
+            profiler_.DrawOverlay();
         }
 
 		////////////////////////////////////////////////////////////////////////////////
@@ -13,85 +13,35 @@
 #include "imgui.h"
 #include "imgui_internal.h"
 
+#include "NodesBezier.h"
+#include "NodesDrawCache.h"
+#include "NodesFormats.h"
+#include "NodesHistory.h"
+#include "NodesJson.h"
+#include "NodesPool.h"
+#include "NodesProfiler.h"
+#include "NodesSearch.h"
+#include "NodesSelection.h"
+#include "NodesSpatial.h"
+#include "NodesTypes.h"
+
 #include <memory>
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <unordered_map>
 
 namespace ImGui
 {
 	////////////////////////////////////////////////////////////////////////////////
 
-    struct NodePadType
-    {
-        std::string name;
-        std::string access;
-        std::string format;
-    };
-
-    struct NodeType
-    {
-        std::string name;
-        std::vector<NodePadType> pads;
-    };
-
-	template<int n>
-	struct BezierWeights
-	{
-		constexpr BezierWeights() : x_(), y_(), z_(), w_()
-		{
-			for (int i = 1; i <= n; ++i)
-			{
-				float t = (float)i / (float)(n + 1);
-				float u = 1.0f - t;
-
-				x_[i - 1] = u * u * u;
-				y_[i - 1] = 3 * u * u * t;
-				z_[i - 1] = 3 * u * t * t;
-				w_[i - 1] = t * t * t;
-			}
-		}
-
-		float x_[n];
-		float y_[n];
-		float z_[n];
-		float w_[n];
-	};
-
-	static constexpr auto bezier_weights_ = BezierWeights<16>();
-
-	////////////////////////////////////////////////////////////////////////////////
-    static const std::vector<ImGui::NodeType> node_types =
-    {
-        ////////////////////////////////////////////////////////////////////////////////
-        {
-            { std::string("MOCAPBridge") },
-
-            {
-                { std::string("Trigger"), std::string("sw"), std::string("f") },
-                { std::string("Markers"), std::string("re"), std::string("f") },
-                { std::string("Skeleton"), std::string("re"), std::string("f") }
-            }
-        },
-        {
-            { std::string("OSCSender") },
-
-            {
-                { std::string("Host Address"), std::string("sw"), std::string("s") },
-                { std::string("data"), std::string("w"), std::string("f") },
-            }
-        }
-    };
-
-
-	////////////////////////////////////////////////////////////////////////////////
-
     class NodeEditor
 	{
     protected:
 		////////////////////////////////////////////////////////////////////////////////
 
         struct Node;
+        struct NodePadLink;
 
         struct NodePad
         {
@@ -101,8 +51,15 @@ namespace ImGui
             //TODO: std::string widget_type   // type of widget for the gui
             std::string access;         // access string, ie r,w,e || s, this also determines whether it is an output(r) or input(w) pad!
             std::string format;         // to determine data type
+            uint32_t access_flags;      // access resolved to NodePadAccess flags
+            NodeFormatId format_id;     // format interned in GetNodeFormats()
+            ImVec2 name_size_;          // cached CalcTextSize of name at the owner's text_scale_
             Node* owner;                // owner of the pad
-            //TODO: std::set<NodePad*> subscriptions; // list of subscriptions (only used  for output pads)
+            std::vector<NodePadLink*> links_out; // links leaving this pad (only used for output pads)
+            std::vector<NodePadLink*> links_in;  // links arriving at this pad (only used for input pads)
+
+            NodePad* inner;             // on a folded group: the member pad this one stands for, see NodesGroups.cpp
+            NodePad* proxy;             // on a member of a folded group: the group pad its links are drawn at
 
             uint32_t connections_;
 
@@ -113,9 +70,12 @@ namespace ImGui
                 name = std::string("noname");
                 access = std::string("r");
                 format = std::string("f");
+                access_flags = NodePadAccess_Read;
+                format_id = NodeFormat_None;
                 owner = nullptr;
+                inner = nullptr;
+                proxy = nullptr;
                 //widget_type = std::string("default");
-                //subscriptions = std::set<NodePad*>();
 
                 connections_ = 0;
             }
@@ -130,6 +90,18 @@ namespace ImGui
         {
             NodePad* source;
             NodePad* sink;
+
+            ImRect hull_;               // bounds of the bezier control points in canvas space
+
+            size_t index_;              // position in node_links
+            size_t source_slot_;        // position in source->links_out
+            size_t sink_slot_;          // position in sink->links_in
+
+            std::vector<ImVec2> polyline_;  // flattened curve in canvas space, drawn and picked
+            float polyline_scale_;      // canvas scale it was flattened for, 0 = never
+            uint64_t polyline_key_;     // GetLinkKey when it was flattened
+
+            NodeDrawCache draw_cache_;  // retained geometry, keyed on GetLinkKey
         };
 
 		////////////////////////////////////////////////////////////////////////////////
@@ -141,8 +113,9 @@ namespace ImGui
 
         struct Node
         {
-            int32_t id_; // 0 = empty, positive/negative = not selected/selected
+            int32_t id_; // 0 = empty, selection is kept apart in NodeEditor::selection_
             int32_t state_;
+            size_t index_;          // position in nodes_
 
             ImVec2 position_;
             ImVec2 size_;
@@ -150,19 +123,57 @@ namespace ImGui
             float collapsed_height;
             float full_height;
 
+            uint32_t select_query_; // last rubber-band query that reported this node
+            uint32_t revision_;     // bumped whenever position, size or look changes
+            uint32_t visible_frame_; // last frame the node was inside the viewport
+
+            uint32_t order_;        // position in the editor's topological order, sources first
+            uint32_t order_visit_;  // last order search that reached this node
+
+            ImVec2 title_size_;     // cached CalcTextSize of name_ ...
+            float text_scale_;      // ... and of the pad names, measured at this canvas scale (< 0 = stale)
+
             std::string name_;
-            std::vector<std::unique_ptr<NodePad>> pads;
+            std::string type_;              // name of the NodeType the node was created from
+            std::vector<NodePad*> pads;     // owned by the editor's pad pool, a group's are made from its members'
+
+            Node* parent_;                  // group the node is a member of, nullptr at the top level
+            std::vector<Node*> members_;    // groups only
+            size_t member_slot_;            // position in parent_->members_
+            uint32_t depth_;                // groups around the node
+            bool group_;                    // type_ is node_group_type_
+            bool hidden_;                   // inside a folded group: not in the grids, neither drawn nor picked
+            bool frame_dirty_;              // open group whose members moved
+
+            NodeDrawCache draw_cache_;      // retained geometry, see DisplayNode
 
             Node()
             {
                 id_ = 0;
                 state_ = NodeStateFlag_Default;
+                index_ = 0;
 
                 position_ = ImVec2(0.0f, 0.0f);
                 size_ = ImVec2(0.0f, 0.0f);
 
                 collapsed_height = 0.0f;
                 full_height = 0.0f;
+
+                select_query_ = 0;
+                revision_ = 0;
+                visible_frame_ = 0;
+
+                order_ = 0;
+                order_visit_ = 0;
+
+                text_scale_ = -1.0f;
+
+                parent_ = nullptr;
+                member_slot_ = 0;
+                depth_ = 0;
+                group_ = false;
+                hidden_ = false;
+                frame_dirty_ = false;
             }
 
             Node* Get()
@@ -193,6 +204,14 @@ namespace ImGui
             NodeState_SelectedConnection
 		};
 
+        // level of detail, chosen per frame from the on-screen text height
+        enum NodeDetail : uint32_t
+        {
+            NodeDetail_Full = 0,        // text, pads, rounded corners, bezier links
+            NodeDetail_Flat,            // nodes are flat quads without text and pads
+            NodeDetail_Bundled          // links are straight and merged when their ends share a cell
+        };
+
         struct currentNode
 		{
             NodeState state_;
@@ -219,9 +238,64 @@ namespace ImGui
 
 		////////////////////////////////////////////////////////////////////////////////
 
-		std::vector<std::unique_ptr<Node>> nodes_;
+		std::vector<Node*> nodes_;
         std::vector<NodePadLink*> node_links;
 
+        // graph storage, nodes_ and node_links only hold pointers into these
+        NodePool<Node> node_pool_;
+        NodePool<NodePad> pad_pool_;
+        NodePool<NodePadLink> link_pool_;
+
+        SpatialGrid<Node> node_grid_;   // canvas space index of node rects
+        uint32_t select_query_;
+
+        SpatialGrid<NodePadLink> link_grid_; // canvas space index of link control hulls
+
+        SegmentBatch hover_batch_;           // segments of the pick candidates, tested against the mouse in one batch
+        std::vector<NodePadLink*> hover_links_;
+        std::vector<ImVec2> link_points_;    // scratch, a link polyline in screen space
+
+        // topological order of nodes along node_links (Pearce-Kelly), deleted nodes leave a nullptr
+        std::vector<Node*> order_;
+        size_t order_holes_;
+        uint32_t order_visit_;
+        std::vector<Node*> order_forward_;  // scratch for AddLinkOrder
+        std::vector<Node*> order_backward_;
+        std::vector<Node*> order_stack_;
+        std::vector<uint32_t> order_slots_;
+
+        std::vector<Node*> visible_nodes_;   // nodes inside the viewport this frame, in draw order
+        uint32_t visible_frame_;
+        NodeSelection selection_;            // ids of the selected nodes
+
+        NodeProfiler profiler_;
+        bool profiler_visible_;
+
+        bool retained_;                      // replay unchanged nodes and links from their draw caches
+        float retained_scale_;               // canvas scale of the previous frame, nothing is captured while zooming
+        uint32_t retained_replayed_;         // nodes and links replayed / drawn this frame
+        uint32_t retained_drawn_;
+
+        NodeHistory history_;
+        std::unordered_map<int32_t, Node*> node_ids_; // by positive id, records refer to nodes by id
+        ImVec2 drag_delta_;                  // movement of the drag in progress, recorded as one step on release
+        NodeSubgraph clipboard_;             // copied nodes and the links between them
+
+        std::vector<int32_t> dirty_groups_;  // top level nodes whose groups changed, see UpdateGroups
+        std::vector<int32_t> dirty_frames_;  // open groups to fit around their members again
+
+        NodeTypeSearch search_;              // type palette of the context menu
+        char search_text_[64];
+        size_t search_max_;                  // results laid out at most
+        std::vector<const NodeType*> search_results_;
+        int search_cursor_;                  // result picked by enter
+        bool search_focus_;                  // the palette just opened, focus its text field
+
+        NodeDetail detail_;
+        float detail_flat_;                  // text height in pixels below which nodes are drawn flat
+        float detail_bundled_;               // ... and links are bundled
+        std::vector<uint64_t> bundles_;      // scratch for RenderLines, packed end cells of each link
+
 		int32_t id_;
         currentNode cur_node_;
 		
@@ -234,83 +308,142 @@ namespace ImGui
 
 		////////////////////////////////////////////////////////////////////////////////
 
-		float ImVec2Dot(const ImVec2& S1, const ImVec2& S2)
-		{
-			return (S1.x * S2.x + S1.y * S2.y);
-		}
-
-		float GetSquaredDistancePointSegment(const ImVec2& P, const ImVec2& S1, const ImVec2& S2)
+        bool IsPadHovered(ImVec2 connection, float radius)
 		{
-			const float l2 = (S1.x - S2.x) * (S1.x - S2.x) + (S1.y - S2.y) * (S1.y - S2.y);
 
-			if (l2 < 1.0f)
-			{
-				return (P.x - S2.x) * (P.x - S2.x) + (P.y - S2.y) * (P.y - S2.y);
-			}
+			ImVec2 delta = ImGui::GetIO().MousePos - connection;
 
-			ImVec2 PS1(P.x - S1.x, P.y - S1.y);
-			ImVec2 T(S2.x - S1.x, S2.y - S2.y);
-			
-			const float tf = ImVec2Dot(PS1, T) / l2;
-			const float minTf = 1.0f < tf ? 1.0f : tf;
-			const float t = 0.0f > minTf ? 0.0f : minTf;
-			
-			T.x = S1.x + T.x * t;
-			T.y = S1.y + T.y * t;
-
-			return (P.x - T.x) * (P.x - T.x) + (P.y - T.y) * (P.y - T.y);
+			return ((delta.x * delta.x) + (delta.y * delta.y)) < (radius * radius);
 		}
 
-		float GetSquaredDistanceToBezierCurve(const ImVec2& point, const ImVec2& p1, const ImVec2& p2, const ImVec2& p3, const ImVec2& p4)
-		{
-			float minSquaredDistance = FLT_MAX;
-			float tmp;
-
-			ImVec2 L = p1;
-			ImVec2 temp;
+        ImRect GetNodeRect(const Node& node) const
+        {
+            return ImRect(node.position_, node.position_ + node.size_);
+        }
 
-			for (int i = 1; i < 16 - 1; ++i)
-			{
-				const ImVec4& W = ImVec4(bezier_weights_.x_[i], bezier_weights_.y_[i], bezier_weights_.z_[i], bezier_weights_.w_[i]);
+        ImRect ScreenToCanvas(const ImRect& rect, ImVec2 offset) const
+        {
+            return ImRect((rect.Min - offset) / canvas_scale_, (rect.Max - offset) / canvas_scale_);
+        }
 
-				temp.x = W.x * p1.x + W.y * p2.x + W.z * p3.x + W.w * p4.x;
-				temp.y = W.x * p1.y + W.y * p2.y + W.z * p3.y + W.w * p4.y;
+        // part of the canvas currently shown in the scrolling region
+        ImRect GetVisibleCanvasRect() const
+        {
+            return ImRect((ImVec2(0.0f, 0.0f) - canvas_scroll_) / canvas_scale_, (canvas_size_ - canvas_scroll_) / canvas_scale_);
+        }
 
-				tmp = GetSquaredDistancePointSegment(point, L, temp);
+        bool IsSelectingState() const
+        {
+            return cur_node_.state_ == NodeState_Selected || cur_node_.state_ == NodeState_DraggingSelected || cur_node_.state_ == NodeState_SelectingMore;
+        }
 
-				if (minSquaredDistance > tmp)
-				{
-					minSquaredDistance = tmp;
-				}
+        // while a pad is dragged every compatible pad on the canvas is highlighted
+        bool IsDraggingPadState() const
+        {
+            return cur_node_.state_ >= NodeState_DraggingInput && cur_node_.state_ <= NodeState_DraggingOutputValid;
+        }
 
-				L = temp;
-			}
+        // a link end inside a folded group is drawn at the group pad standing for it ...
+        static NodePad* GetShownPad(NodePad* pad)
+        {
+            return pad->proxy ? pad->proxy : pad;
+        }
 
-			tmp = GetSquaredDistancePointSegment(point, L, p4);
+        // ... and a link made to a group pad goes to the member pad behind it
+        static NodePad* GetInnerPad(NodePad* pad)
+        {
+            return pad->inner ? pad->inner : pad;
+        }
 
-			if (minSquaredDistance > tmp)
-			{
-				minSquaredDistance = tmp;
-			}
+        // both ends inside one folded group
+        static bool IsLinkHidden(const NodePadLink& link)
+        {
+            return GetShownPad(link.source)->owner->hidden_ || GetShownPad(link.sink)->owner->hidden_;
+        }
 
-			return minSquaredDistance;
-		}
+        static bool IsOpenGroup(const Node& node)
+        {
+            return node.group_ && node.state_ > 0;
+        }
 
-		////////////////////////////////////////////////////////////////////////////////
+        // an open group is only picked by its title band, its members sit in the rest of its rect
+        ImRect GetHitRect(const Node& node) const
+        {
+            return IsOpenGroup(node) ? ImRect(node.position_, node.position_ + ImVec2(node.size_.x, node.collapsed_height)) : GetNodeRect(node);
+        }
 
-        bool IsPadHovered(ImVec2 connection, float radius)
-		{
+        void GetLinkEndpoints(const NodePadLink& link, ImVec2& p1, ImVec2& p4) const;
 
-			ImVec2 delta = ImGui::GetIO().MousePos - connection;
+        // a link only changes shape when one of its nodes does
+        uint64_t GetLinkKey(const NodePadLink& link) const
+        {
+            return ((uint64_t)GetShownPad(link.source)->owner->revision_ << 32) | GetShownPad(link.sink)->owner->revision_;
+        }
 
-			return ((delta.x * delta.x) + (delta.y * delta.y)) < (radius * radius);
-		}
+        const std::vector<ImVec2>& GetLinkPolyline(NodePadLink& link);
+        const std::vector<ImVec2>& GetLinkScreenPolyline(NodePadLink& link, ImVec2 offset);
+        float GetSquaredDistanceToLink(NodePadLink& link, ImVec2 point, ImVec2 offset);
+        void UpdateLinkBounds(NodePadLink& link);
+        void UpdateNodeBounds(Node& node);
 
 		Node* GetHoverNode(ImVec2 offset, ImVec2 pos);
 		void DisplayNode(ImDrawList* drawList, ImVec2 offset, Node& node);
-        void AddNodePadLink(NodePad* source, NodePad* sink);
+        void DisplayNodeFlat(ImDrawList* drawList, const Node& node, ImVec2 node_rect_min, ImVec2 node_rect_max, bool highlighted);
+        void DisplayGroupFrame(ImDrawList* drawList, Node& node, ImVec2 node_rect_min, ImVec2 node_rect_max, bool highlighted);
+        void RenderBundles(ImDrawList* draw_list, ImVec2 offset, const ImRect& visible);
+        void AttachNode(Node* node);
+        bool WouldCreateCycle(Node* source, Node* sink);
+        bool AddLinkOrder(Node* source, Node* sink);
+        void RemoveNodeOrder(Node* node);
+        size_t RebuildOrder();
+        NodePadLink* AddNodePadLink(NodePad* source, NodePad* sink);
+        NodePadLink* AttachLink(NodePad* source, NodePad* sink);
         void DeleteNodePadLink(NodePadLink* link);
         void DeleteSelectedNodes();
+        void DeleteNodes(const std::vector<Node*>& nodes);
+        void RemoveNode(Node* node);
+        void DestroyNode(Node* node);
+        void CreateNodePads(Node& node, const std::vector<NodePadType>& types);
+        void LayoutNode(Node& node, const Node* model = nullptr);
+        void UpdateTextLayout(Node& node);
+        void ToggleCollapsed(Node& node);
+
+        Node* FindNode(int32_t id) const;
+
+        // detached subgraphs and batched node creation, see NodesSubgraph.cpp
+        void StoreLink(const NodePadLink& link, NodeSubgraph& graph) const;
+        void StoreNodes(const std::vector<Node*>& nodes, NodeSubgraph& graph, bool external_links) const;
+        void CreateNodes(const GraphFileNode* records, size_t count, const GraphFilePad* pads, const NodeStrings& strings, ImVec2 offset, bool new_ids, std::vector<Node*>& created);
+        size_t AddLinks(const NodeSubgraph& graph, const std::unordered_map<int32_t, Node*>* remap);
+        void InsertSubgraph(const NodeSubgraph& graph, ImVec2 offset, bool new_ids, std::vector<Node*>& created);
+        void GetSelectedNodes(std::vector<Node*>& nodes) const;
+        void PasteSubgraph(const NodeSubgraph& graph, ImVec2 offset);
+
+        // groups, see NodesGroups.cpp
+        void SetParent(Node& node, Node* parent);
+        void MarkGroupDirty(const Node& node);
+        void MarkFrameDirty(Node& group);
+        void UpdateGroups();
+        void UpdateGroupTree(Node& node, Node* folded, uint32_t depth);
+        void UpdateTreeLinks(Node& node);
+        void UpdateGroupFrame(Node& group);
+        void BuildProxies(Node& group);
+        void ClearProxies(Node& group);
+        void OffsetNode(Node& node, ImVec2 delta);
+        bool HasSelectedAncestor(const Node& node) const;
+        void DissolveGroup(Node& group);
+        void RecordGroups(NodeHistoryType type, const std::vector<Node*>& groups);
+
+        // undo journal, see NodesHistory.cpp
+        void RemoveNodes(const NodeSubgraph& graph);
+        void RemoveLinks(const NodeSubgraph& graph);
+        void MoveNodes(const std::vector<int32_t>& ids, ImVec2 delta);
+        void RecordCreate(const std::vector<Node*>& nodes);
+        void RecordLink(NodeHistoryType type, const NodePadLink& link);
+        void RecordMove(const std::vector<int32_t>& ids, ImVec2 delta);
+        void RecordCollapse(const Node& node);
+        void RecordDeleteSelected();
+        void ApplyHistory(const NodeHistoryRecord& record, bool undo);
 		////////////////////////////////////////////////////////////////////////////////
 		
 		void UpdateScroll();
@@ -318,6 +451,8 @@ namespace ImGui
 		void RenderLines(ImDrawList* draw_list, ImVec2 offset);
 		void DisplayNodes(ImDrawList* drawList, ImVec2 offset);
 
+        struct JsonImport;  // JsonHandler that rebuilds the graph, see NodesJson.cpp
+
         ////////////////////////////////////////////////////////////////////////////////
 
 	public:
@@ -325,10 +460,64 @@ namespace ImGui
         ~NodeEditor();
 
 		void ProcessNodes();
+
+        void SetProfilerVisible(bool visible) { profiler_visible_ = visible; }
+        bool IsProfilerVisible() const { return profiler_visible_; }
+        const NodeProfiler& GetProfiler() const { return profiler_; }
+
+        // retained rendering replays the geometry of nodes and links nobody interacts with
+        void SetRetainedRendering(bool retained) { retained_ = retained; }
+        bool IsRetainedRendering() const { return retained_; }
+
+        // on-screen text heights in pixels where zooming out switches to flat nodes and to bundled links
+        void SetDetailThresholds(float flat, float bundled) { detail_flat_ = flat; detail_bundled_ = bundled; }
+
+        // number of types the search palette shows for a query
+        void SetSearchResultCount(size_t count) { search_max_ = count; }
+        void ClearGraph();
+
+        void SelectAll();
+        void ClearSelection() { selection_.Clear(); }
+        const NodeSelection& GetSelection() const { return selection_; }
+
+        // edits made through the canvas can be undone, loading or clearing a graph forgets them
+        bool Undo();
+        bool Redo();
+        bool CanUndo() const { return history_.CanUndo(); }
+        bool CanRedo() const { return history_.CanRedo(); }
+        void SetHistoryBudget(size_t bytes) { history_.SetBudget(bytes); }
+        const NodeHistory& GetHistory() const { return history_; }
+
+        // the clipboard lives in the editor, pasted nodes get new ids and are selected
+        bool CopySelection();
+        bool PasteClipboard(ImVec2 position);
+        bool DuplicateSelection();
+
+        // a group folds into one node showing the member pads linked outside of it; groups nest
+        bool GroupSelection();
+        bool UngroupSelection();
+
+        // nodes in an order where every link points forward
+        void GetTopologicalOrder(std::vector<NodeEditor::Node*>& order) const;
+        void RenameNode(NodeEditor::Node& node, const std::string& name);
+
+        // binary graph files, see NodesFile.h
+        bool SaveGraph(const std::string& path);
+        bool LoadGraph(const std::string& path);
+
+        // JSON interchange files, written and read in one streaming pass
+        bool ExportJson(const std::string& path);
+        bool ImportJson(const std::string& path, const JsonProgress& progress = JsonProgress());
+
         NodeEditor::Node*  CreateNodeFromType(ImVec2 pos, const NodeType& type);
+        // one node of type per position, laid out once and shared by the batch
+        void CreateNodesFromType(const NodeType& type, const std::vector<ImVec2>& positions, std::vector<NodeEditor::Node*>& created);
         virtual void LinkAdded(NodeEditor::NodePad*& src, NodePad*& sink) {};
         virtual void LinkDeleted(NodeEditor::NodePad*& src, NodePad*& sink) {};
+        // a stored link that was left out because it would close a cycle
+        virtual void LinkRejected(NodeEditor::NodePad*& src, NodePad*& sink) {};
         virtual void NodeAdded(NodeEditor::Node& node) {};
         virtual void NodeDeleted(NodeEditor::Node& node) {};
+        virtual void GraphCleared() {};
     };
 }
@@ -0,0 +1,552 @@
+// Binary graph file format for the node graph editor
+
+#include "NodesEdit.h"
+#include "NodesFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    // read only view of a whole file, mapped when the platform allows it
+    class MappedGraphFile
+    {
+        const uint8_t* data_;
+        size_t size_;
+#ifdef _WIN32
+        HANDLE file_;
+        HANDLE mapping_;
+#endif
+
+    public:
+        explicit MappedGraphFile(const std::string& path) : data_(nullptr), size_(0)
+        {
+#ifdef _WIN32
+            mapping_ = nullptr;
+            file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE) return;
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) return;
+
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping_) return;
+
+            data_ = (const uint8_t*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+            if (data_) size_ = (size_t)size.QuadPart;
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+
+            struct stat info;
+            if (fstat(fd, &info) == 0 && info.st_size > 0)
+            {
+                void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED)
+                {
+                    madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+                    data_ = (const uint8_t*)data;
+                    size_ = (size_t)info.st_size;
+                }
+            }
+
+            close(fd); // the mapping stays valid
+#endif
+        }
+
+        ~MappedGraphFile()
+        {
+#ifdef _WIN32
+            if (data_) UnmapViewOfFile(data_);
+            if (mapping_) CloseHandle(mapping_);
+            if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#else
+            if (data_) munmap((void*)data_, size_);
+#endif
+        }
+
+        MappedGraphFile(const MappedGraphFile&) = delete;
+        MappedGraphFile& operator=(const MappedGraphFile&) = delete;
+
+        const uint8_t* Data() const { return data_; }
+        size_t Size() const { return size_; }
+    };
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    static uint64_t AlignGraphFileOffset(uint64_t offset)
+    {
+        return (offset + 7) & ~(uint64_t)7;
+    }
+
+    // one Kahn pass over the records, links are followed from pad to node the way LoadGraph resolves them
+    static bool IsGraphFileAcyclic(const GraphFileNode* nodes, uint32_t node_count, const GraphFileLink* links, uint32_t link_count, uint32_t pad_count)
+    {
+        std::vector<uint32_t> pad_owner(pad_count, UINT32_MAX);
+        for (uint32_t i = 0; i < node_count; ++i)
+        {
+            for (uint32_t p = 0; p < nodes[i].pad_count; ++p)
+            {
+                pad_owner[nodes[i].first_pad + p] = i;
+            }
+        }
+
+        // outgoing links per node, stored contiguously
+        std::vector<uint32_t> first_out(node_count + 1, 0);
+        std::vector<uint32_t> incoming(node_count, 0);
+
+        for (uint32_t i = 0; i < link_count; ++i)
+        {
+            const uint32_t source = pad_owner[links[i].source];
+            const uint32_t sink = pad_owner[links[i].sink];
+
+            if (source != UINT32_MAX && sink != UINT32_MAX)
+            {
+                ++first_out[source + 1];
+                ++incoming[sink];
+            }
+        }
+
+        for (uint32_t i = 0; i < node_count; ++i)
+        {
+            first_out[i + 1] += first_out[i];
+        }
+
+        std::vector<uint32_t> sinks(first_out[node_count]);
+        std::vector<uint32_t> fill(first_out.begin(), first_out.end() - 1);
+
+        for (uint32_t i = 0; i < link_count; ++i)
+        {
+            const uint32_t source = pad_owner[links[i].source];
+            const uint32_t sink = pad_owner[links[i].sink];
+
+            if (source != UINT32_MAX && sink != UINT32_MAX)
+            {
+                sinks[fill[source]++] = sink;
+            }
+        }
+
+        std::vector<uint32_t> queue;
+        queue.reserve(node_count);
+        for (uint32_t i = 0; i < node_count; ++i)
+        {
+            if (incoming[i] == 0)
+            {
+                queue.push_back(i);
+            }
+        }
+
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            const uint32_t node = queue[head];
+            for (uint32_t l = first_out[node]; l < first_out[node + 1]; ++l)
+            {
+                if (--incoming[sinks[l]] == 0)
+                {
+                    queue.push_back(sinks[l]);
+                }
+            }
+        }
+
+        return queue.size() == node_count;
+    }
+
+    bool NodeEditor::SaveGraph(const std::string& path)
+    {
+        std::string string_data;
+        std::vector<uint32_t> string_offsets;
+        std::unordered_map<std::string, uint32_t> string_ids;
+
+        auto intern = [&](const std::string& str) -> uint32_t
+        {
+            auto it = string_ids.find(str);
+            if (it != string_ids.end()) return it->second;
+
+            const uint32_t id = (uint32_t)string_offsets.size();
+            string_offsets.push_back((uint32_t)string_data.size());
+            string_data.append(str.c_str(), str.size() + 1);
+            string_ids.emplace(str, id);
+            return id;
+        };
+
+        ////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<GraphFileNode> nodes;
+        std::vector<GraphFilePad> pads;
+        std::vector<GraphFileMember> members;
+        std::unordered_map<const NodePad*, uint32_t> pad_index;
+
+        nodes.reserve(nodes_.size());
+        pads.reserve(pad_pool_.Size());
+        pad_index.reserve(pad_pool_.Size());
+
+        for (auto& node : nodes_)
+        {
+            GraphFileNode record;
+            record.id = node->id_;
+            record.state = node->state_;
+            record.position[0] = node->position_.x;
+            record.position[1] = node->position_.y;
+            record.size[0] = node->size_.x;
+            record.size[1] = node->size_.y;
+            record.collapsed_height = node->collapsed_height;
+            record.full_height = node->full_height;
+            record.name = intern(node->name_);
+            record.type = intern(node->type_);
+            record.first_pad = (uint32_t)pads.size();
+            record.pad_count = node->group_ ? 0 : (uint32_t)node->pads.size();
+            nodes.push_back(record);
+
+            if (node->parent_)
+            {
+                members.push_back({ node->id_, node->parent_->id_ });
+            }
+
+            for (uint32_t p = 0; p < record.pad_count; ++p)
+            {
+                const NodePad* pad = node->pads[p];
+
+                GraphFilePad pad_record;
+                pad_record.name = intern(pad->name);
+                pad_record.access = intern(pad->access);
+                pad_record.format = intern(pad->format);
+                pad_record.position[0] = pad->position.x;
+                pad_record.position[1] = pad->position.y;
+                pad_record.position_out[0] = pad->position_out.x;
+                pad_record.position_out[1] = pad->position_out.y;
+
+                pad_index.emplace(pad, (uint32_t)pads.size());
+                pads.push_back(pad_record);
+            }
+        }
+
+        std::vector<GraphFileLink> links;
+        links.reserve(node_links.size());
+
+        for (auto& link : node_links)
+        {
+            links.push_back({ pad_index[link->source], pad_index[link->sink] });
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+
+        GraphFileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, graph_file_magic_, sizeof(header.magic));
+        header.version = graph_file_version_;
+        header.byte_order = graph_file_byte_order_;
+        header.header_size = sizeof(GraphFileHeader);
+        header.last_id = id_;
+        header.canvas_scroll[0] = canvas_scroll_.x;
+        header.canvas_scroll[1] = canvas_scroll_.y;
+        header.canvas_scale = canvas_scale_;
+
+        const void* data[GraphFileSection_COUNT] = { nullptr, nodes.data(), pads.data(), links.data(), members.data() };
+
+        uint64_t offset = AlignGraphFileOffset(sizeof(GraphFileHeader));
+        header.sections[GraphFileSection_Strings] = { GraphFileSection_Strings, (uint32_t)string_offsets.size(), offset, string_offsets.size() * sizeof(uint32_t) + string_data.size() };
+        offset = AlignGraphFileOffset(offset + header.sections[GraphFileSection_Strings].size);
+        header.sections[GraphFileSection_Nodes] = { GraphFileSection_Nodes, (uint32_t)nodes.size(), offset, nodes.size() * sizeof(GraphFileNode) };
+        offset = AlignGraphFileOffset(offset + header.sections[GraphFileSection_Nodes].size);
+        header.sections[GraphFileSection_Pads] = { GraphFileSection_Pads, (uint32_t)pads.size(), offset, pads.size() * sizeof(GraphFilePad) };
+        offset = AlignGraphFileOffset(offset + header.sections[GraphFileSection_Pads].size);
+        header.sections[GraphFileSection_Links] = { GraphFileSection_Links, (uint32_t)links.size(), offset, links.size() * sizeof(GraphFileLink) };
+        offset = AlignGraphFileOffset(offset + header.sections[GraphFileSection_Links].size);
+        header.sections[GraphFileSection_Groups] = { GraphFileSection_Groups, (uint32_t)members.size(), offset, members.size() * sizeof(GraphFileMember) };
+
+        ////////////////////////////////////////////////////////////////////////////////
+
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            return false;
+        }
+
+        static const char padding[8] = {};
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        uint64_t written = sizeof(header);
+
+        for (int i = 0; i < (int)GraphFileSection_COUNT && ok; ++i)
+        {
+            const GraphFileSection& section = header.sections[i];
+
+            ok &= fwrite(padding, 1, (size_t)(section.offset - written), file) == section.offset - written;
+
+            if (i == GraphFileSection_Strings)
+            {
+                ok &= string_offsets.empty() || fwrite(string_offsets.data(), sizeof(uint32_t), string_offsets.size(), file) == string_offsets.size();
+                ok &= string_data.empty() || fwrite(string_data.data(), 1, string_data.size(), file) == string_data.size();
+            }
+            else if (section.size)
+            {
+                ok &= fwrite(data[i], 1, (size_t)section.size, file) == section.size;
+            }
+
+            written = section.offset + section.size;
+        }
+
+        ok &= fclose(file) == 0;
+        return ok;
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    bool NodeEditor::LoadGraph(const std::string& path)
+    {
+        MappedGraphFile file(path);
+
+        // version 1 headers end before the groups section
+        const size_t header_size_v1 = sizeof(GraphFileHeader) - sizeof(GraphFileSection);
+
+        if (file.Size() < header_size_v1)
+        {
+            return false;
+        }
+
+        GraphFileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(&header, file.Data(), file.Size() < sizeof(header) ? file.Size() : sizeof(header));
+
+        const int section_count = header.version == 1 ? (int)GraphFileSection_Groups : (int)GraphFileSection_COUNT;
+
+        if (memcmp(header.magic, graph_file_magic_, sizeof(header.magic)) != 0 ||
+            header.version < 1 || header.version > graph_file_version_ ||
+            header.byte_order != graph_file_byte_order_ ||
+            header.header_size < (header.version == 1 ? header_size_v1 : sizeof(GraphFileHeader)))
+        {
+            return false;
+        }
+
+        if (header.last_id < 0 || header.last_id > graph_file_max_id_ ||
+            !IsGraphFileCoordinate(header.canvas_scroll[0]) || !IsGraphFileCoordinate(header.canvas_scroll[1]))
+        {
+            return false;
+        }
+
+        if (section_count < (int)GraphFileSection_COUNT)
+        {
+            header.sections[GraphFileSection_Groups] = { GraphFileSection_Groups, 0, 0, 0 };
+        }
+
+        // every section must lie inside the file, be aligned and match its record count
+        static const size_t record_sizes[GraphFileSection_COUNT] = { sizeof(uint32_t), sizeof(GraphFileNode), sizeof(GraphFilePad), sizeof(GraphFileLink), sizeof(GraphFileMember) };
+
+        for (int i = 0; i < section_count; ++i)
+        {
+            const GraphFileSection& section = header.sections[i];
+
+            if (section.type != (uint32_t)i || section.offset % 4 != 0 || section.offset > file.Size() || section.size > file.Size() - section.offset)
+            {
+                return false;
+            }
+
+            if (i == GraphFileSection_Strings ? section.size < section.count * record_sizes[i] : section.size != section.count * record_sizes[i])
+            {
+                return false;
+            }
+        }
+
+        const GraphFileSection& string_section = header.sections[GraphFileSection_Strings];
+        const uint32_t* string_offsets = (const uint32_t*)(file.Data() + string_section.offset);
+        const char* string_data = (const char*)(string_offsets + string_section.count);
+        const uint64_t string_data_size = string_section.size - string_section.count * sizeof(uint32_t);
+
+        if (string_section.count && (string_data_size == 0 || string_data[string_data_size - 1] != '\0'))
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < string_section.count; ++i)
+        {
+            if (string_offsets[i] >= string_data_size) return false;
+        }
+
+        const GraphFileNode* nodes = (const GraphFileNode*)(file.Data() + header.sections[GraphFileSection_Nodes].offset);
+        const GraphFilePad* pads = (const GraphFilePad*)(file.Data() + header.sections[GraphFileSection_Pads].offset);
+        const GraphFileLink* links = (const GraphFileLink*)(file.Data() + header.sections[GraphFileSection_Links].offset);
+
+        const uint32_t node_count = header.sections[GraphFileSection_Nodes].count;
+        const uint32_t pad_count = header.sections[GraphFileSection_Pads].count;
+        const uint32_t link_count = header.sections[GraphFileSection_Links].count;
+
+        const GraphFileMember* members = (const GraphFileMember*)(file.Data() + header.sections[GraphFileSection_Groups].offset);
+        const uint32_t member_count = header.sections[GraphFileSection_Groups].count;
+
+        auto valid_string = [&](uint32_t index) { return index < string_section.count; };
+
+        std::vector<int32_t> ids;
+        ids.reserve(node_count);
+
+        for (uint32_t i = 0; i < node_count; ++i)
+        {
+            const GraphFileNode& node = nodes[i];
+            if (node.id <= 0 || !valid_string(node.name) || !valid_string(node.type) || node.first_pad > pad_count || node.pad_count > pad_count - node.first_pad)
+            {
+                return false;
+            }
+
+            // the layout is taken as stored, it goes straight into the spatial grids
+            if (node.id > graph_file_max_id_ ||
+                !IsGraphFileCoordinate(node.position[0]) || !IsGraphFileCoordinate(node.position[1]) ||
+                !IsGraphFileSize(node.size[0]) || !IsGraphFileSize(node.size[1]) ||
+                !IsGraphFileSize(node.collapsed_height) || !IsGraphFileSize(node.full_height))
+            {
+                return false;
+            }
+
+            // a group's pads are proxies made from its members, pads of its own would be destroyed under their links
+            if (node.pad_count && strcmp(string_data + string_offsets[node.type], node_group_type_) == 0)
+            {
+                return false;
+            }
+
+            ids.push_back(node.id);
+        }
+
+        // two nodes under one id could never both be found again
+        std::sort(ids.begin(), ids.end());
+        if (std::adjacent_find(ids.begin(), ids.end()) != ids.end())
+        {
+            return false;
+        }
+
+        // no pad record may belong to two nodes
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;
+        ranges.reserve(node_count);
+
+        for (uint32_t i = 0; i < node_count; ++i)
+        {
+            if (nodes[i].pad_count)
+            {
+                ranges.emplace_back(nodes[i].first_pad, nodes[i].pad_count);
+            }
+        }
+
+        std::sort(ranges.begin(), ranges.end());
+        for (size_t i = 1; i < ranges.size(); ++i)
+        {
+            if (ranges[i - 1].first + ranges[i - 1].second > ranges[i].first) return false;
+        }
+
+        // access and format strings are resolved once each, pads share a handful of them
+        NodeFormatTable& formats = GetNodeFormats();
+        std::vector<uint32_t> string_access(string_section.count, UINT32_MAX);
+        std::vector<int32_t> string_format(string_section.count, -1);
+
+        auto pad_access = [&](uint32_t pad)
+        {
+            uint32_t& flags = string_access[pads[pad].access];
+            if (flags == UINT32_MAX)
+            {
+                flags = ParseNodePadAccess(string_data + string_offsets[pads[pad].access]);
+            }
+            return flags;
+        };
+
+        auto pad_format = [&](uint32_t pad)
+        {
+            int32_t& format = string_format[pads[pad].format];
+            if (format < 0)
+            {
+                format = formats.Intern(string_data + string_offsets[pads[pad].format]);
+            }
+            return (NodeFormatId)format;
+        };
+
+        // every format is interned up front, a file that runs the table out of ids is refused
+        for (uint32_t i = 0; i < pad_count; ++i)
+        {
+            if (!valid_string(pads[i].name) || !valid_string(pads[i].access) || !valid_string(pads[i].format)) return false;
+
+            if (!IsGraphFileCoordinate(pads[i].position[0]) || !IsGraphFileCoordinate(pads[i].position[1]) ||
+                !IsGraphFileCoordinate(pads[i].position_out[0]) || !IsGraphFileCoordinate(pads[i].position_out[1])) return false;
+
+            if (pad_format(i) == NodeFormat_Invalid) return false;
+        }
+
+        // a link the editor would not let the user draw is not taken from a file either
+        for (uint32_t i = 0; i < link_count; ++i)
+        {
+            if (links[i].source >= pad_count || links[i].sink >= pad_count) return false;
+
+            if (!formats.CanLink(pad_access(links[i].source), pad_format(links[i].source), pad_access(links[i].sink), pad_format(links[i].sink))) return false;
+        }
+
+        // a cycle cannot come from SaveGraph, the file is refused before the graph is touched
+        if (!IsGraphFileAcyclic(nodes, node_count, links, link_count, pad_count))
+        {
+            return false;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+
+        // the file is valid, rebuild the graph in one pass with storage reserved up front
+        ClearGraph();
+
+        link_pool_.Reserve(link_count);
+        node_links.reserve(link_count);
+
+        id_ = header.last_id;
+
+        std::vector<Node*> created;
+        CreateNodes(nodes, node_count, pads, NodeStrings{ string_offsets, string_data }, ImVec2(0.0f, 0.0f), false, created);
+
+        std::vector<NodePad*> pad_lookup(pad_count, nullptr);
+
+        for (uint32_t i = 0; i < node_count; ++i)
+        {
+            for (uint32_t p = 0; p < nodes[i].pad_count; ++p)
+            {
+                pad_lookup[nodes[i].first_pad + p] = created[i]->pads[p];
+            }
+        }
+
+        for (uint32_t i = 0; i < link_count; ++i)
+        {
+            NodePad* source = pad_lookup[links[i].source];
+            NodePad* sink = pad_lookup[links[i].sink];
+
+            // pads not claimed by any node cannot be linked
+            if (source && sink)
+            {
+                AttachLink(source, sink);
+            }
+        }
+
+        // nodes_ is in id order, not in link order: one Kahn pass instead of a step per link
+        RebuildOrder();
+
+        // membership by id, a member of a missing group stays at the top level
+        for (uint32_t i = 0; i < member_count; ++i)
+        {
+            Node* node = FindNode(members[i].node);
+            Node* group = FindNode(members[i].group);
+
+            if (node && group && group->group_)
+            {
+                SetParent(*node, group);
+            }
+        }
+
+        UpdateGroups();
+
+        canvas_scroll_ = ImVec2(header.canvas_scroll[0], header.canvas_scroll[1]);
+        canvas_scale_ = header.canvas_scale > 0.0f ? ImClamp(header.canvas_scale, 0.3f, 3.0f) : 1.0f;
+
+        return true;
+    }
+}
@@ -0,0 +1,112 @@
+// Binary graph file format for the node graph editor
+//
+// A file is a header followed by sections of fixed size records, laid out so
+// that a memory mapped file can be read in place:
+//
+//   GraphFileHeader
+//   GraphFileSection_Strings  uint32_t offsets[count], then the NUL terminated characters
+//   GraphFileSection_Nodes    GraphFileNode[count]
+//   GraphFileSection_Pads     GraphFilePad[count], grouped per node in node order
+//   GraphFileSection_Links    GraphFileLink[count], pads referenced by their index in the pad section
+//   GraphFileSection_Groups   GraphFileMember[count], since version 2
+//
+// Group nodes are stored without pads, they are made again from the members.
+//
+// All values are stored in the byte order of the machine that wrote the file,
+// GraphFileHeader::byte_order tells readers when that is not their own.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    static const char graph_file_magic_[4] = { 'O', 'F', 'N', 'G' };
+    static const uint32_t graph_file_version_ = 2;
+    static const uint32_t graph_file_byte_order_ = 0x01020304;
+
+    // limits on what a graph file, binary or JSON, may hold: new ids are handed out above the highest
+    // one in use, and canvas positions and sizes go into the spatial grids and the layout as floats
+    static const int32_t graph_file_max_id_ = 1 << 30;
+    static const float graph_file_max_extent_ = 1.0e6f;
+
+    inline bool IsGraphFileCoordinate(float value)
+    {
+        return std::isfinite(value) && std::fabs(value) <= graph_file_max_extent_;
+    }
+
+    inline bool IsGraphFileSize(float value)
+    {
+        return std::isfinite(value) && value >= 0.0f && value <= graph_file_max_extent_;
+    }
+
+    enum GraphFileSectionType : uint32_t
+    {
+        GraphFileSection_Strings = 0,
+        GraphFileSection_Nodes,
+        GraphFileSection_Pads,
+        GraphFileSection_Links,
+        GraphFileSection_Groups,
+        GraphFileSection_COUNT
+    };
+
+    struct GraphFileSection
+    {
+        uint32_t type;
+        uint32_t count;     // number of records
+        uint64_t offset;    // from the start of the file
+        uint64_t size;      // in bytes
+    };
+
+    struct GraphFileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t header_size;
+
+        int32_t last_id;            // highest node id in use
+        float canvas_scroll[2];
+        float canvas_scale;
+
+        GraphFileSection sections[GraphFileSection_COUNT];
+    };
+
+    struct GraphFileNode
+    {
+        int32_t id;                 // always positive, selection is not stored
+        int32_t state;              // negative = collapsed
+        float position[2];
+        float size[2];
+        float collapsed_height;
+        float full_height;
+        uint32_t name;              // string index
+        uint32_t type;              // string index
+        uint32_t first_pad;
+        uint32_t pad_count;
+    };
+
+    struct GraphFilePad
+    {
+        uint32_t name;              // string index
+        uint32_t access;            // string index
+        uint32_t format;            // string index
+        float position[2];
+        float position_out[2];
+    };
+
+    struct GraphFileLink
+    {
+        uint32_t source;            // pad index
+        uint32_t sink;              // pad index
+    };
+
+    struct GraphFileMember
+    {
+        int32_t node;               // node id
+        int32_t group;              // node id of the group holding it
+    };
+}
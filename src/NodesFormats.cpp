@@ -0,0 +1,74 @@
+// Pad access flags and data format table for the node graph editor
+
+#include "NodesFormats.h"
+
+namespace ImGui
+{
+    uint32_t ParseNodePadAccess(const std::string& access)
+    {
+        uint32_t flags = NodePadAccess_None;
+
+        for (char c : access)
+        {
+            switch (c)
+            {
+                case 'r': flags |= NodePadAccess_Read; break;
+                case 'w': flags |= NodePadAccess_Write; break;
+                case 'e': flags |= NodePadAccess_Emit; break;
+                case 's': flags |= NodePadAccess_Static; break;
+                default: break;
+            }
+        }
+
+        return flags;
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    NodeFormatTable::NodeFormatTable()
+    {
+        Intern(std::string()); // NodeFormat_None
+    }
+
+    NodeFormatId NodeFormatTable::Intern(const std::string& format)
+    {
+        auto it = ids_.find(format);
+        if (it != ids_.end())
+        {
+            return it->second;
+        }
+
+        // formats come from files too, running out of ids must not wrap onto taken ones
+        if (names_.size() >= NodeFormat_Invalid)
+        {
+            return NodeFormat_Invalid;
+        }
+
+        const NodeFormatId id = (NodeFormatId)names_.size();
+
+        ids_.emplace(format, id);
+        names_.push_back(format);
+
+        return id;
+    }
+
+    void NodeFormatTable::SetCompatible(NodeFormatId source, NodeFormatId sink, bool compatible)
+    {
+        const uint32_t pair = ((uint32_t)source << 16) | sink;
+
+        if (compatible)
+        {
+            compatible_.insert(pair);
+        }
+        else
+        {
+            compatible_.erase(pair);
+        }
+    }
+
+    NodeFormatTable& GetNodeFormats()
+    {
+        static NodeFormatTable formats;
+        return formats;
+    }
+}
@@ -0,0 +1,73 @@
+// Pad access flags and data format table for the node graph editor
+//
+// NodePadType describes access and format as strings. They are resolved once
+// when a node is created, so the draw loop only compares integers.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    enum NodePadAccess : uint32_t
+    {
+        NodePadAccess_None = 0,
+        NodePadAccess_Read = 1 << 0,    // 'r' output pad, can be a link source
+        NodePadAccess_Write = 1 << 1,   // 'w' input pad, can be a link sink
+        NodePadAccess_Emit = 1 << 2,    // 'e' value is emitted on change
+        NodePadAccess_Static = 1 << 3   // 's' value is set once, ie a setting
+    };
+
+    uint32_t ParseNodePadAccess(const std::string& access);
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    typedef uint16_t NodeFormatId;
+
+    static const NodeFormatId NodeFormat_None = 0;          // empty format string, pad is not drawn
+    static const NodeFormatId NodeFormat_Invalid = 0xFFFF;  // from Intern once every id is taken, never connects
+
+    // interned pad formats and which source format may feed which sink format; a format always
+    // feeds itself, only the other pairs allowed are stored, so the table grows with what is used
+    class NodeFormatTable
+    {
+        std::unordered_map<std::string, NodeFormatId> ids_;
+        std::vector<std::string> names_;
+        std::unordered_set<uint32_t> compatible_;   // (source << 16) | sink
+
+    public:
+        NodeFormatTable();
+
+        // NodeFormat_Invalid when the format is new and every id is taken
+        NodeFormatId Intern(const std::string& format);
+        const std::string& GetName(NodeFormatId id) const { return names_[id]; }
+        size_t Size() const { return names_.size(); }
+
+        // a format and itself are compatible regardless, pads without format never connect
+        void SetCompatible(NodeFormatId source, NodeFormatId sink, bool compatible = true);
+
+        bool IsCompatible(NodeFormatId source, NodeFormatId sink) const
+        {
+            if (source == NodeFormat_None || source == NodeFormat_Invalid || sink == NodeFormat_None || sink == NodeFormat_Invalid)
+            {
+                return false;
+            }
+
+            return source == sink || compatible_.count(((uint32_t)source << 16) | sink) != 0;
+        }
+
+        // what a link drag on the canvas allows: an output pad feeding an input pad of a compatible format
+        bool CanLink(uint32_t source_access, NodeFormatId source, uint32_t sink_access, NodeFormatId sink) const
+        {
+            return (source_access & NodePadAccess_Read) && (sink_access & NodePadAccess_Write) && IsCompatible(source, sink);
+        }
+    };
+
+    NodeFormatTable& GetNodeFormats();
+}
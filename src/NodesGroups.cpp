@@ -0,0 +1,486 @@
+// Groups for the node graph editor
+//
+// A group is a node of type node_group_type_ whose members are other nodes,
+// groups included. Open, it is a frame around its members and is picked by
+// its title band only. Folded (state_ < 0, toggled like a collapsed node) it
+// is one node with a proxy pad for every member pad linked outside of it,
+// and everything inside it leaves the node and link grids: RenderLines and
+// DisplayNodes never visit it, however large it is. Links always stay between
+// member pads, only their drawn ends move to the proxies.
+//
+// Membership, folding and links of hidden nodes only mark what they touch,
+// UpdateGroups applies them once per frame over each top level tree.
+
+#include "NodesEdit.h"
+
+#include <algorithm>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    // refused when it would put a group inside itself
+    void NodeEditor::SetParent(Node& node, Node* parent)
+    {
+        if (node.parent_ == parent)
+        {
+            return;
+        }
+
+        for (const Node* group = parent; group; group = group->parent_)
+        {
+            if (group == &node)
+            {
+                return;
+            }
+        }
+
+        // swap and pop, like nodes_
+        if (Node* old = node.parent_)
+        {
+            MarkGroupDirty(*old);
+
+            Node* moved = old->members_.back();
+            old->members_[node.member_slot_] = moved;
+            moved->member_slot_ = node.member_slot_;
+            old->members_.pop_back();
+        }
+
+        node.parent_ = parent;
+
+        if (parent)
+        {
+            node.member_slot_ = parent->members_.size();
+            parent->members_.push_back(&node);
+        }
+
+        MarkGroupDirty(node);
+    }
+
+    // a fold changes what every group around it shows, the whole top level tree is updated
+    void NodeEditor::MarkGroupDirty(const Node& node)
+    {
+        const Node* root = &node;
+        while (root->parent_)
+        {
+            root = root->parent_;
+        }
+
+        dirty_groups_.push_back(root->id_);
+    }
+
+    void NodeEditor::MarkFrameDirty(Node& group)
+    {
+        if (!group.frame_dirty_)
+        {
+            group.frame_dirty_ = true;
+            dirty_frames_.push_back(group.id_);
+        }
+    }
+
+    void NodeEditor::UpdateGroups()
+    {
+        if (!dirty_groups_.empty())
+        {
+            // nodes may have joined a group since they were marked
+            for (int32_t& id : dirty_groups_)
+            {
+                const Node* node = FindNode(id);
+                while (node && node->parent_)
+                {
+                    node = node->parent_;
+                }
+
+                id = node ? node->id_ : 0;
+            }
+
+            std::sort(dirty_groups_.begin(), dirty_groups_.end());
+            dirty_groups_.erase(std::unique(dirty_groups_.begin(), dirty_groups_.end()), dirty_groups_.end());
+
+            for (int32_t id : dirty_groups_)
+            {
+                if (Node* root = FindNode(id))
+                {
+                    UpdateGroupTree(*root, nullptr, 0);
+                    UpdateTreeLinks(*root);
+                }
+            }
+
+            dirty_groups_.clear();
+
+            // the node or link under the mouse may just have been folded away
+            if ((cur_node_.node_ && cur_node_.node_->hidden_) || (cur_node_.link && IsLinkHidden(*cur_node_.link)))
+            {
+                cur_node_.Reset();
+            }
+        }
+
+        // moving a group marks the one around it in turn
+        for (size_t i = 0; i < dirty_frames_.size(); ++i)
+        {
+            Node* group = FindNode(dirty_frames_[i]);
+            if (!group || !group->frame_dirty_)
+            {
+                continue;
+            }
+
+            group->frame_dirty_ = false;
+            UpdateGroupFrame(*group);
+            UpdateNodeBounds(*group);
+        }
+
+        dirty_frames_.clear();
+    }
+
+    // folded is the outermost folded group around node, members are done before their group
+    void NodeEditor::UpdateGroupTree(Node& node, Node* folded, uint32_t depth)
+    {
+        node.hidden_ = folded != nullptr;
+        node.depth_ = depth;
+
+        if (!node.group_)
+        {
+            for (NodePad* pad : node.pads)
+            {
+                pad->proxy = nullptr;
+            }
+        }
+        else
+        {
+            Node* inner = folded ? folded : (node.state_ < 0 ? &node : nullptr);
+
+            for (Node* member : node.members_)
+            {
+                UpdateGroupTree(*member, inner, depth + 1);
+            }
+
+            // only the outermost folded group stands in for what is inside it
+            ClearProxies(node);
+            if (!folded && node.state_ < 0)
+            {
+                BuildProxies(node);
+            }
+
+            UpdateGroupFrame(node);
+        }
+
+        if (node.hidden_)
+        {
+            node_grid_.Remove(&node);
+        }
+        else
+        {
+            UpdateNodeBounds(node);
+        }
+    }
+
+    // once every proxy of the tree is known, links show, hide or move to their new ends
+    void NodeEditor::UpdateTreeLinks(Node& node)
+    {
+        for (Node* member : node.members_)
+        {
+            UpdateTreeLinks(*member);
+        }
+
+        for (NodePad* pad : node.pads)
+        {
+            for (NodePadLink* link : pad->links_out)
+            {
+                link->polyline_scale_ = 0.0f;
+                link->draw_cache_.Invalidate();
+                UpdateLinkBounds(*link);
+            }
+
+            for (NodePadLink* link : pad->links_in)
+            {
+                link->polyline_scale_ = 0.0f;
+                link->draw_cache_.Invalidate();
+                UpdateLinkBounds(*link);
+            }
+        }
+    }
+
+    // a group sits over the top left corner of its members, open it spans all of them
+    void NodeEditor::UpdateGroupFrame(Node& group)
+    {
+        LayoutNode(group);
+
+        if (group.members_.empty())
+        {
+            return;
+        }
+
+        ImRect bounds = GetNodeRect(*group.members_[0]);
+        for (const Node* member : group.members_)
+        {
+            bounds.Add(GetNodeRect(*member));
+        }
+
+        const float margin = group.title_size_.y;
+        group.position_ = bounds.Min - ImVec2(margin, margin + group.collapsed_height);
+
+        if (group.state_ > 0)
+        {
+            group.size_ = bounds.Max + ImVec2(margin, margin) - group.position_;
+        }
+    }
+
+    // one pad for every member pad linked outside the group, in member order
+    void NodeEditor::BuildProxies(Node& group)
+    {
+        auto inside = [&group](const Node* node)
+        {
+            for (; node; node = node->parent_)
+            {
+                if (node == &group) return true;
+            }
+            return false;
+        };
+
+        std::vector<Node*> stack(group.members_.rbegin(), group.members_.rend());
+
+        while (!stack.empty())
+        {
+            Node* node = stack.back();
+            stack.pop_back();
+
+            if (node->group_)
+            {
+                stack.insert(stack.end(), node->members_.rbegin(), node->members_.rend());
+                continue;
+            }
+
+            for (NodePad* pad : node->pads)
+            {
+                uint32_t crossing = 0;
+
+                for (const NodePadLink* link : pad->links_out)
+                {
+                    crossing += inside(link->sink->owner) ? 0 : 1;
+                }
+
+                for (const NodePadLink* link : pad->links_in)
+                {
+                    crossing += inside(link->source->owner) ? 0 : 1;
+                }
+
+                if (!crossing)
+                {
+                    continue;
+                }
+
+                NodePad* proxy = pad_pool_.Create();
+                proxy->name = node->name_ + "." + pad->name;
+                proxy->access = pad->access;
+                proxy->format = pad->format;
+                proxy->access_flags = pad->access_flags;
+                proxy->format_id = pad->format_id;
+                proxy->owner = &group;
+                proxy->inner = pad;
+                proxy->connections_ = crossing;
+
+                pad->proxy = proxy;
+                group.pads.push_back(proxy);
+            }
+        }
+    }
+
+    void NodeEditor::ClearProxies(Node& group)
+    {
+        for (NodePad* proxy : group.pads)
+        {
+            // inner is cleared when its node is destroyed first
+            if (proxy->inner && proxy->inner->proxy == proxy)
+            {
+                proxy->inner->proxy = nullptr;
+            }
+
+            if (cur_node_.selected_pad == proxy)
+            {
+                cur_node_.Reset();
+            }
+
+            pad_pool_.Destroy(proxy);
+        }
+
+        group.pads.clear();
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // a group takes everything inside it along
+    void NodeEditor::OffsetNode(Node& node, ImVec2 delta)
+    {
+        node.position_ += delta;
+
+        for (Node* member : node.members_)
+        {
+            OffsetNode(*member, delta);
+        }
+
+        UpdateNodeBounds(node);
+    }
+
+    bool NodeEditor::HasSelectedAncestor(const Node& node) const
+    {
+        for (const Node* group = node.parent_; group; group = group->parent_)
+        {
+            if (selection_.Contains(group->id_))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // the members go to the group around this one, the group node is destroyed
+    void NodeEditor::DissolveGroup(Node& group)
+    {
+        ClearProxies(group);
+
+        while (!group.members_.empty())
+        {
+            SetParent(*group.members_.back(), group.parent_);
+        }
+
+        SetParent(group, nullptr);
+        node_grid_.Remove(&group);
+        RemoveNode(&group);
+        DestroyNode(&group);
+    }
+
+    // the groups with their place in the tree and their members, whichever way the record is applied
+    void NodeEditor::RecordGroups(NodeHistoryType type, const std::vector<Node*>& groups)
+    {
+        NodeHistoryRecord& record = history_.Push(type);
+        StoreNodes(groups, record.graph, false);
+
+        for (const Node* group : groups)
+        {
+            for (const Node* member : group->members_)
+            {
+                record.graph.members.push_back({ member->id_, group->id_ });
+            }
+        }
+
+        history_.Commit();
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // the outermost selected nodes go into a new group, they have to share their parent
+    bool NodeEditor::GroupSelection()
+    {
+        std::vector<Node*> members;
+        for (int32_t id : selection_)
+        {
+            Node* node = FindNode(id);
+            if (!HasSelectedAncestor(*node))
+            {
+                members.push_back(node);
+            }
+        }
+
+        if (members.empty())
+        {
+            return false;
+        }
+
+        Node* parent = members[0]->parent_;
+        for (const Node* member : members)
+        {
+            if (member->parent_ != parent)
+            {
+                return false;
+            }
+        }
+
+        std::sort(members.begin(), members.end(), [](const Node* a, const Node* b) { return a->id_ < b->id_; });
+
+        Node* group = node_pool_.Create();
+        group->id_ = ++id_;
+        group->name_ = std::string("Group") + std::to_string(id_);
+        group->type_ = node_group_type_;
+
+        LayoutNode(*group);
+        AttachNode(group);
+
+        SetParent(*group, parent);
+        for (Node* member : members)
+        {
+            SetParent(*member, group);
+        }
+
+        UpdateGroups();
+        RecordGroups(NodeHistory_Group, std::vector<Node*>(1, group));
+
+        selection_.Clear();
+        selection_.Add(group->id_);
+        cur_node_.Reset(NodeState_Selected);
+        return true;
+    }
+
+    // every selected group, its members stay where they are and are selected instead
+    bool NodeEditor::UngroupSelection()
+    {
+        std::vector<Node*> groups;
+        for (int32_t id : selection_)
+        {
+            Node* node = FindNode(id);
+            if (node->group_)
+            {
+                groups.push_back(node);
+            }
+        }
+
+        if (groups.empty())
+        {
+            return false;
+        }
+
+        RecordGroups(NodeHistory_Ungroup, groups);
+
+        for (const Node* group : groups)
+        {
+            for (const Node* member : group->members_)
+            {
+                selection_.Add(member->id_);
+            }
+        }
+
+        for (Node* group : groups)
+        {
+            DissolveGroup(*group);
+        }
+
+        UpdateGroups();
+        cur_node_.Reset(NodeState_Selected);
+        return true;
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // an open group is a frame behind its members, only the title band takes the mouse
+    void NodeEditor::DisplayGroupFrame(ImDrawList* drawList, Node& node, ImVec2 node_rect_min, ImVec2 node_rect_max, bool highlighted)
+    {
+        const ImVec2 title_area(node_rect_max.x, node_rect_min.y + (node.collapsed_height * canvas_scale_));
+
+        drawList->AddRectFilled(node_rect_min, node_rect_max, ImColor(0.25f, 0.25f, 0.25f, 0.3f));
+        drawList->AddRectFilled(node_rect_min, title_area, ImColor(0.25f, 0.0f, 0.125f, 0.9f));
+        drawList->AddRect(node_rect_min, node_rect_max, ImColor(0.25f, 0.0f, 0.125f, 0.9f));
+
+        if (detail_ == NodeDetail_Full)
+        {
+            UpdateTextLayout(node);
+
+            ImGui::SetCursorScreenPos(ImVec2(node_rect_min.x + node.title_size_.y, node_rect_min.y + ((title_area.y - node_rect_min.y) / 2.0f) - (node.title_size_.y / 2.0f)));
+            ImGui::Text("%s", node.name_.c_str());
+        }
+
+        if (highlighted)
+        {
+            drawList->AddRectFilled(node_rect_min, title_area, ImColor(1.0f, 1.0f, 1.0f, 0.25f));
+        }
+    }
+}
@@ -0,0 +1,311 @@
+// Undo/redo journal for the node graph editor
+
+#include "NodesEdit.h"
+#include "NodesHistory.h"
+
+#include <algorithm>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    NodeHistory::NodeHistory()
+    {
+        position_ = 0;
+        bytes_ = 0;
+        budget_ = 16 * 1024 * 1024;
+    }
+
+    NodeHistoryRecord& NodeHistory::Push(NodeHistoryType type)
+    {
+        while (records_.size() > position_)
+        {
+            bytes_ -= records_.back().bytes;
+            records_.pop_back();
+        }
+
+        records_.emplace_back();
+
+        NodeHistoryRecord& record = records_.back();
+        record.type = type;
+        record.delta = ImVec2(0.0f, 0.0f);
+        record.bytes = 0;
+
+        ++position_;
+        return record;
+    }
+
+    void NodeHistory::Commit()
+    {
+        NodeHistoryRecord& record = records_.back();
+
+        record.ids.shrink_to_fit();
+        record.graph.Seal();
+        record.bytes = sizeof(NodeHistoryRecord) + record.ids.capacity() * sizeof(int32_t) + record.graph.GetByteSize();
+
+        bytes_ += record.bytes;
+        Trim();
+    }
+
+    void NodeHistory::Trim()
+    {
+        while (bytes_ > budget_ && records_.size() > 1 && position_ > 0)
+        {
+            bytes_ -= records_.front().bytes;
+            records_.pop_front();
+            --position_;
+        }
+    }
+
+    const NodeHistoryRecord* NodeHistory::Undo()
+    {
+        return position_ > 0 ? &records_[--position_] : nullptr;
+    }
+
+    const NodeHistoryRecord* NodeHistory::Redo()
+    {
+        return position_ < records_.size() ? &records_[position_++] : nullptr;
+    }
+
+    void NodeHistory::Clear()
+    {
+        records_.clear();
+        position_ = 0;
+        bytes_ = 0;
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // records list a group together with everything inside it, the selection is left alone
+    void NodeEditor::RemoveNodes(const NodeSubgraph& graph)
+    {
+        std::vector<Node*> nodes;
+        nodes.reserve(graph.nodes.size());
+
+        for (const GraphFileNode& record : graph.nodes)
+        {
+            if (Node* node = FindNode(record.id))
+            {
+                nodes.push_back(node);
+            }
+        }
+
+        DeleteNodes(nodes);
+    }
+
+    void NodeEditor::RemoveLinks(const NodeSubgraph& graph)
+    {
+        for (const NodeSubgraphLink& record : graph.links)
+        {
+            Node* source = FindNode(record.source);
+            Node* sink = FindNode(record.sink);
+
+            if (!source || !sink || record.source_pad >= source->pads.size() || record.sink_pad >= sink->pads.size())
+            {
+                continue;
+            }
+
+            const NodePad* sink_pad = sink->pads[record.sink_pad];
+            for (NodePadLink* link : source->pads[record.source_pad]->links_out)
+            {
+                if (link->sink == sink_pad)
+                {
+                    DeleteNodePadLink(link);
+                    break;
+                }
+            }
+        }
+    }
+
+    // like a drag, a node inside a moved group only moves with it
+    void NodeEditor::MoveNodes(const std::vector<int32_t>& ids, ImVec2 delta)
+    {
+        std::vector<int32_t> sorted(ids);
+        std::sort(sorted.begin(), sorted.end());
+
+        auto moved_with_group = [&sorted](const Node* node)
+        {
+            for (const Node* group = node->parent_; group; group = group->parent_)
+            {
+                if (std::binary_search(sorted.begin(), sorted.end(), group->id_)) return true;
+            }
+            return false;
+        };
+
+        for (int32_t id : ids)
+        {
+            Node* node = FindNode(id);
+            if (node && !moved_with_group(node))
+            {
+                OffsetNode(*node, delta);
+            }
+        }
+    }
+
+    // a group is laid out again by UpdateGroups, folded or not
+    void NodeEditor::ToggleCollapsed(Node& node)
+    {
+        if (node.group_)
+        {
+            node.state_ = -node.state_;
+            MarkGroupDirty(node);
+            return;
+        }
+
+        node.size_.y = node.state_ < 0 ? node.full_height : node.collapsed_height;
+        node.state_ = -node.state_;
+        UpdateNodeBounds(node);
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    void NodeEditor::RecordCreate(const std::vector<Node*>& nodes)
+    {
+        NodeHistoryRecord& record = history_.Push(NodeHistory_Create);
+        StoreNodes(nodes, record.graph, false);
+        history_.Commit();
+    }
+
+    void NodeEditor::RecordLink(NodeHistoryType type, const NodePadLink& link)
+    {
+        NodeHistoryRecord& record = history_.Push(type);
+        StoreLink(link, record.graph);
+        history_.Commit();
+    }
+
+    void NodeEditor::RecordMove(const std::vector<int32_t>& ids, ImVec2 delta)
+    {
+        if (ids.empty() || (delta.x == 0.0f && delta.y == 0.0f))
+        {
+            return;
+        }
+
+        NodeHistoryRecord& record = history_.Push(NodeHistory_Move);
+        record.ids = ids;
+        record.delta = delta;
+        history_.Commit();
+    }
+
+    void NodeEditor::RecordCollapse(const Node& node)
+    {
+        NodeHistoryRecord& record = history_.Push(NodeHistory_Collapse);
+        record.ids.push_back(node.id_);
+        history_.Commit();
+    }
+
+    // call before DeleteSelectedNodes
+    void NodeEditor::RecordDeleteSelected()
+    {
+        if (selection_.Empty())
+        {
+            return;
+        }
+
+        std::vector<Node*> selected;
+        GetSelectedNodes(selected);
+
+        NodeHistoryRecord& record = history_.Push(NodeHistory_Delete);
+        StoreNodes(selected, record.graph, true);
+        history_.Commit();
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    void NodeEditor::ApplyHistory(const NodeHistoryRecord& record, bool undo)
+    {
+        switch (record.type)
+        {
+            case NodeHistory_Create:
+            case NodeHistory_Delete:
+            {
+                if (undo == (record.type == NodeHistory_Create))
+                {
+                    RemoveNodes(record.graph);
+                }
+                else
+                {
+                    std::vector<Node*> created;
+                    InsertSubgraph(record.graph, ImVec2(0.0f, 0.0f), false, created);
+                }
+            } break;
+
+            case NodeHistory_LinkAdd:
+            case NodeHistory_LinkDelete:
+            {
+                if (undo == (record.type == NodeHistory_LinkAdd))
+                {
+                    RemoveLinks(record.graph);
+                }
+                else
+                {
+                    AddLinks(record.graph, nullptr);
+                }
+            } break;
+
+            case NodeHistory_Move:
+            {
+                MoveNodes(record.ids, undo ? ImVec2(0.0f, 0.0f) - record.delta : record.delta);
+            } break;
+
+            case NodeHistory_Group:
+            case NodeHistory_Ungroup:
+            {
+                if (undo == (record.type == NodeHistory_Group))
+                {
+                    for (const GraphFileNode& group : record.graph.nodes)
+                    {
+                        if (Node* node = FindNode(group.id))
+                        {
+                            DissolveGroup(*node);
+                        }
+                    }
+                }
+                else
+                {
+                    // the groups come back under their ids and the members are found again by theirs
+                    std::vector<Node*> created;
+                    InsertSubgraph(record.graph, ImVec2(0.0f, 0.0f), false, created);
+                }
+            } break;
+
+            case NodeHistory_Collapse:
+            {
+                for (int32_t id : record.ids)
+                {
+                    if (Node* node = FindNode(id))
+                    {
+                        ToggleCollapsed(*node);
+                    }
+                }
+            } break;
+        }
+    }
+
+    bool NodeEditor::Undo()
+    {
+        const NodeHistoryRecord* record = history_.Undo();
+        if (!record)
+        {
+            return false;
+        }
+
+        cur_node_.Reset();
+        ApplyHistory(*record, true);
+        UpdateGroups();
+        return true;
+    }
+
+    bool NodeEditor::Redo()
+    {
+        const NodeHistoryRecord* record = history_.Redo();
+        if (!record)
+        {
+            return false;
+        }
+
+        cur_node_.Reset();
+        ApplyHistory(*record, false);
+        UpdateGroups();
+        return true;
+    }
+}
@@ -0,0 +1,83 @@
+// Undo/redo journal for the node graph editor
+//
+// Every edit is kept as a delta, never as a copy of the graph: a move is the
+// moved node ids and one offset, a collapse the toggled ids, and created or
+// deleted nodes and links a subgraph (see NodesSubgraph.h) that rebuilds them
+// under their old ids. Grouping keeps the group nodes and their membership,
+// the members stay where they are.
+//
+// The journal keeps the newest records within a byte budget, the oldest undo
+// steps are dropped first.
+
+#pragma once
+
+#define IMGUI_DEFINE_MATH_OPERATORS
+
+#include "imgui.h"
+
+#include "NodesSubgraph.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    enum NodeHistoryType : uint32_t
+    {
+        NodeHistory_Create = 0,     // graph holds the created nodes and the links between them
+        NodeHistory_Delete,         // graph holds the deleted nodes and every link they had
+        NodeHistory_Move,           // ids moved by delta
+        NodeHistory_Collapse,       // ids had their collapsed state toggled
+        NodeHistory_LinkAdd,        // graph holds the added links
+        NodeHistory_LinkDelete,     // graph holds the deleted links
+        NodeHistory_Group,          // graph holds the created groups and who is a member of them
+        NodeHistory_Ungroup         // graph holds the dissolved groups and who was a member of them
+    };
+
+    struct NodeHistoryRecord
+    {
+        NodeHistoryType type;
+        std::vector<int32_t> ids;
+        ImVec2 delta;
+        NodeSubgraph graph;
+        size_t bytes;
+    };
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    class NodeHistory
+    {
+        std::deque<NodeHistoryRecord> records_;
+        size_t position_;           // records before this one can be undone, the rest redone
+        size_t bytes_;
+        size_t budget_;
+
+        void Trim();
+
+    public:
+        NodeHistory();
+
+        // starts a record and drops everything that could have been redone,
+        // fill it in and Commit it before the next Push
+        NodeHistoryRecord& Push(NodeHistoryType type);
+        void Commit();
+
+        // the record to revert / apply again, nullptr when there is none
+        const NodeHistoryRecord* Undo();
+        const NodeHistoryRecord* Redo();
+
+        bool CanUndo() const { return position_ > 0; }
+        bool CanRedo() const { return position_ < records_.size(); }
+
+        void Clear();
+
+        // the newest record is kept even when it alone is over the budget
+        void SetBudget(size_t bytes) { budget_ = bytes; Trim(); }
+        size_t GetBudget() const { return budget_; }
+        size_t GetBytes() const { return bytes_; }
+        size_t GetCount() const { return records_.size(); }
+    };
+}
@@ -0,0 +1,1189 @@
+// Streaming JSON reader and writer for the node graph editor
+
+#include "NodesEdit.h"
+#include "NodesJson.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    JsonReader::JsonReader() : in_(nullptr), pos_(0), end_(0), consumed_(0), total_(0)
+    {
+    }
+
+    bool JsonReader::Refill()
+    {
+        if (!in_ || !*in_)
+        {
+            return false;
+        }
+
+        consumed_ += end_;
+
+        in_->read(buffer_.data(), (std::streamsize)buffer_.size());
+        pos_ = 0;
+        end_ = (size_t)in_->gcount();
+
+        if (progress_)
+        {
+            progress_(consumed_ + end_, total_);
+        }
+
+        return end_ > 0;
+    }
+
+    int JsonReader::Peek()
+    {
+        if (pos_ == end_ && !Refill())
+        {
+            return -1;
+        }
+
+        return (unsigned char)buffer_[pos_];
+    }
+
+    int JsonReader::Get()
+    {
+        const int c = Peek();
+
+        if (c >= 0)
+        {
+            ++pos_;
+        }
+
+        return c;
+    }
+
+    bool JsonReader::SkipWhitespace()
+    {
+        for (;;)
+        {
+            const int c = Peek();
+
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+            {
+                return c >= 0;
+            }
+
+            ++pos_;
+        }
+    }
+
+    bool JsonReader::Fail(const char* message)
+    {
+        if (error_.empty())
+        {
+            error_ = message;
+        }
+
+        return false;
+    }
+
+    static void AppendUtf8(std::string& out, uint32_t cp)
+    {
+        if (cp < 0x80)
+        {
+            out += (char)cp;
+        }
+        else if (cp < 0x800)
+        {
+            out += (char)(0xC0 | (cp >> 6));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            out += (char)(0xE0 | (cp >> 12));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            out += (char)(0xF0 | (cp >> 18));
+            out += (char)(0x80 | ((cp >> 12) & 0x3F));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool JsonReader::ParseString(std::string& out)
+    {
+        out.clear();
+        Get(); // opening quote
+
+        auto hex4 = [this](uint32_t& value) -> bool
+        {
+            value = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                const int c = Get();
+                value <<= 4;
+                if (c >= '0' && c <= '9') value |= (uint32_t)(c - '0');
+                else if (c >= 'a' && c <= 'f') value |= (uint32_t)(c - 'a' + 10);
+                else if (c >= 'A' && c <= 'F') value |= (uint32_t)(c - 'A' + 10);
+                else return false;
+            }
+            return true;
+        };
+
+        for (;;)
+        {
+            const int c = Get();
+
+            if (c < 0) return Fail("unterminated string");
+            if (c == '"') return true;
+            if (c < 0x20) return Fail("control character in string");
+
+            if (c != '\\')
+            {
+                out += (char)c;
+                continue;
+            }
+
+            switch (Get())
+            {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u':
+                {
+                    uint32_t cp;
+                    if (!hex4(cp)) return Fail("invalid \\u escape");
+
+                    // surrogate pair
+                    if (cp >= 0xD800 && cp <= 0xDBFF)
+                    {
+                        uint32_t low;
+                        if (Get() != '\\' || Get() != 'u' || !hex4(low) || low < 0xDC00 || low > 0xDFFF)
+                        {
+                            return Fail("invalid surrogate pair");
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+
+                    AppendUtf8(out, cp);
+                } break;
+                default: return Fail("invalid escape");
+            }
+        }
+    }
+
+    bool JsonReader::ParseNumber(double& out)
+    {
+        token_.clear();
+
+        for (;;)
+        {
+            const int c = Peek();
+            if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'))
+            {
+                break;
+            }
+            token_ += (char)c;
+            ++pos_;
+        }
+
+        char* end = nullptr;
+        out = strtod(token_.c_str(), &end);
+
+        if (token_.empty() || end != token_.c_str() + token_.size())
+        {
+            return Fail("invalid number");
+        }
+
+        return true;
+    }
+
+    bool JsonReader::ParseLiteral(const char* literal)
+    {
+        for (const char* c = literal; *c; ++c)
+        {
+            if (Get() != *c) return Fail("invalid literal");
+        }
+
+        return true;
+    }
+
+    bool JsonReader::Parse(std::istream& in, JsonHandler& handler, uint64_t total, const JsonProgress& progress)
+    {
+        in_ = &in;
+        buffer_.resize(64 * 1024);
+        pos_ = end_ = 0;
+        consumed_ = 0;
+        total_ = total;
+        progress_ = progress;
+        error_.clear();
+
+        enum Expect { Expect_Value, Expect_Key, Expect_Colon, Expect_Next };
+
+        struct Frame
+        {
+            bool array;
+            Expect expect;
+            bool empty;
+        };
+
+        std::vector<Frame> stack;
+        bool root_done = false;
+        std::string text;
+
+        while (!root_done)
+        {
+            if (!SkipWhitespace())
+            {
+                return Fail("unexpected end of input");
+            }
+
+            const int c = Peek();
+            Frame* frame = stack.empty() ? nullptr : &stack.back();
+
+            ////////////////////////////////////////////////////////////////////////////////
+            // structure: keys, colons, commas and closing brackets
+
+            if (frame && frame->expect == Expect_Key)
+            {
+                if (c == '}' && frame->empty)
+                {
+                    ++pos_;
+                    stack.pop_back();
+                    if (!handler.EndObject()) return Fail("aborted by handler");
+                }
+                else if (c == '"')
+                {
+                    if (!ParseString(text)) return false;
+                    if (!handler.Key(text)) return Fail("aborted by handler");
+                    frame->expect = Expect_Colon;
+                    continue;
+                }
+                else
+                {
+                    return Fail("expected key");
+                }
+            }
+            else if (frame && frame->expect == Expect_Colon)
+            {
+                if (c != ':') return Fail("expected ':'");
+                ++pos_;
+                frame->expect = Expect_Value;
+                continue;
+            }
+            else if (frame && frame->expect == Expect_Next)
+            {
+                ++pos_;
+
+                if (c == ',')
+                {
+                    frame->expect = frame->array ? Expect_Value : Expect_Key;
+                    frame->empty = false;
+                    continue;
+                }
+
+                if (c == (frame->array ? ']' : '}'))
+                {
+                    const bool array = frame->array;
+                    stack.pop_back();
+                    if (!(array ? handler.EndArray() : handler.EndObject())) return Fail("aborted by handler");
+                }
+                else
+                {
+                    return Fail("expected ',' or closing bracket");
+                }
+            }
+            else if (frame && frame->array && frame->empty && c == ']')
+            {
+                ++pos_;
+                stack.pop_back();
+                if (!handler.EndArray()) return Fail("aborted by handler");
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////
+            // values
+
+            else
+            {
+                bool ok = true;
+
+                switch (c)
+                {
+                    case '{':
+                        ++pos_;
+                        if (frame) frame->expect = Expect_Next;
+                        stack.push_back({ false, Expect_Key, true });
+                        if (!handler.StartObject()) return Fail("aborted by handler");
+                        continue;
+
+                    case '[':
+                        ++pos_;
+                        if (frame) frame->expect = Expect_Next;
+                        stack.push_back({ true, Expect_Value, true });
+                        if (!handler.StartArray()) return Fail("aborted by handler");
+                        continue;
+
+                    case '"':
+                        ok = ParseString(text) && (handler.String(text) || Fail("aborted by handler"));
+                        break;
+
+                    case 't':
+                        ok = ParseLiteral("true") && (handler.Bool(true) || Fail("aborted by handler"));
+                        break;
+
+                    case 'f':
+                        ok = ParseLiteral("false") && (handler.Bool(false) || Fail("aborted by handler"));
+                        break;
+
+                    case 'n':
+                        ok = ParseLiteral("null") && (handler.Null() || Fail("aborted by handler"));
+                        break;
+
+                    default:
+                    {
+                        if (c != '-' && (c < '0' || c > '9')) return Fail("unexpected character");
+
+                        double value;
+                        ok = ParseNumber(value) && (handler.Number(value) || Fail("aborted by handler"));
+                    } break;
+                }
+
+                if (!ok) return false;
+
+                if (frame)
+                {
+                    frame->expect = Expect_Next;
+                }
+                else
+                {
+                    root_done = true;
+                }
+
+                continue;
+            }
+
+            // a container was closed
+            if (stack.empty())
+            {
+                root_done = true;
+            }
+            else
+            {
+                stack.back().expect = Expect_Next;
+            }
+        }
+
+        // only whitespace may follow the root value
+        if (SkipWhitespace())
+        {
+            return Fail("trailing characters");
+        }
+
+        return true;
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    JsonWriter::JsonWriter(std::ostream& out) : out_(out), after_key_(false)
+    {
+    }
+
+    void JsonWriter::NewLine()
+    {
+        out_ << '\n';
+        for (size_t i = 0; i < scopes_.size(); ++i)
+        {
+            out_ << "  ";
+        }
+    }
+
+    void JsonWriter::BeginValue()
+    {
+        if (after_key_)
+        {
+            after_key_ = false;
+            return;
+        }
+
+        if (scopes_.empty())
+        {
+            return;
+        }
+
+        Scope& scope = scopes_.back();
+        if (!scope.empty)
+        {
+            out_ << (scope.compact ? ", " : ",");
+        }
+        scope.empty = false;
+
+        if (!scope.compact)
+        {
+            NewLine();
+        }
+    }
+
+    void JsonWriter::StartObject()
+    {
+        BeginValue();
+        out_ << '{';
+        scopes_.push_back({ false, scopes_.empty() ? false : scopes_.back().compact, true });
+    }
+
+    void JsonWriter::EndObject()
+    {
+        const Scope scope = scopes_.back();
+        scopes_.pop_back();
+
+        if (!scope.empty && !scope.compact)
+        {
+            NewLine();
+        }
+        out_ << '}';
+
+        if (scopes_.empty())
+        {
+            out_ << '\n';
+        }
+    }
+
+    void JsonWriter::StartArray(bool compact)
+    {
+        BeginValue();
+        out_ << '[';
+        scopes_.push_back({ true, compact || (!scopes_.empty() && scopes_.back().compact), true });
+    }
+
+    void JsonWriter::EndArray()
+    {
+        const Scope scope = scopes_.back();
+        scopes_.pop_back();
+
+        if (!scope.empty && !scope.compact)
+        {
+            NewLine();
+        }
+        out_ << ']';
+    }
+
+    void JsonWriter::Key(const std::string& key)
+    {
+        BeginValue();
+        WriteEscaped(key);
+        out_ << ": ";
+        after_key_ = true;
+    }
+
+    void JsonWriter::String(const std::string& value)
+    {
+        BeginValue();
+        WriteEscaped(value);
+    }
+
+    void JsonWriter::WriteEscaped(const std::string& value)
+    {
+        out_ << '"';
+        for (char ch : value)
+        {
+            const unsigned char c = (unsigned char)ch;
+            switch (c)
+            {
+                case '"': out_ << "\\\""; break;
+                case '\\': out_ << "\\\\"; break;
+                case '\b': out_ << "\\b"; break;
+                case '\f': out_ << "\\f"; break;
+                case '\n': out_ << "\\n"; break;
+                case '\r': out_ << "\\r"; break;
+                case '\t': out_ << "\\t"; break;
+                default:
+                    if (c < 0x20)
+                    {
+                        char escaped[8];
+                        snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out_ << escaped;
+                    }
+                    else
+                    {
+                        out_ << ch;
+                    }
+                    break;
+            }
+        }
+        out_ << '"';
+    }
+
+    void JsonWriter::Number(double value)
+    {
+        BeginValue();
+
+        // JSON has no representation for nan and inf
+        if (!std::isfinite(value))
+        {
+            out_ << "null";
+            return;
+        }
+
+        char text[32];
+        snprintf(text, sizeof(text), "%.9g", value);
+        out_ << text;
+    }
+
+    void JsonWriter::Int(int64_t value)
+    {
+        BeginValue();
+        out_ << value;
+    }
+
+    void JsonWriter::Bool(bool value)
+    {
+        BeginValue();
+        out_ << (value ? "true" : "false");
+    }
+
+    void JsonWriter::Null()
+    {
+        BeginValue();
+        out_ << "null";
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+    // graph interchange
+    //
+    // {
+    //   "version": 1,
+    //   "view": { "scroll": [x, y], "scale": s },
+    //   "types": [ { "name": ..., "pads": [ { "name": ..., "access": ..., "format": ... } ] } ],
+    //   "nodes": [ { "id": n, "type": ..., "name": ..., "position": [x, y], "collapsed": b, "group": id, "pads": [ ... ] } ],
+    //   "links": [ { "source": [node id, pad index], "sink": [node id, pad index] } ]
+    // }
+    //
+    // A node without "pads" takes them from its type, first from the file's "types", then from GetNodeTypes().
+    // "group" is the id of the group node holding it, group nodes have no pads of their own.
+
+    static const int graph_json_version_ = 1;
+
+    static void WritePadTypes(JsonWriter& writer, const std::vector<NodePadType>& pads)
+    {
+        writer.Key("pads");
+        writer.StartArray();
+        for (auto& pad : pads)
+        {
+            writer.StartObject();
+            writer.Key("name"); writer.String(pad.name);
+            writer.Key("access"); writer.String(pad.access);
+            writer.Key("format"); writer.String(pad.format);
+            writer.EndObject();
+        }
+        writer.EndArray();
+    }
+
+    bool NodeEditor::ExportJson(const std::string& path)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::vector<char> buffer(256 * 1024);
+        file.rdbuf()->pubsetbuf(buffer.data(), (std::streamsize)buffer.size());
+
+        JsonWriter writer(file);
+        writer.StartObject();
+
+        writer.Key("version"); writer.Int(graph_json_version_);
+
+        writer.Key("view");
+        writer.StartObject();
+        writer.Key("scroll");
+        writer.StartArray(true); writer.Number(canvas_scroll_.x); writer.Number(canvas_scroll_.y); writer.EndArray();
+        writer.Key("scale"); writer.Number(canvas_scale_);
+        writer.EndObject();
+
+        writer.Key("types");
+        writer.StartArray();
+        const NodeTypeRegistry& registry = GetNodeTypes();
+        for (size_t i = 0; i < registry.Size(); ++i)
+        {
+            const NodeType& type = registry[i];
+            writer.StartObject();
+            writer.Key("name"); writer.String(type.name);
+            WritePadTypes(writer, type.pads);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        ////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<NodePadType> pad_types;
+
+        // a group has no registered type, its pads are always written (as none)
+        auto has_type_pads = [](const Node& node) -> bool
+        {
+            const NodeType* type = node.group_ ? nullptr : GetNodeTypes().Find(node.type_);
+            if (!type || type->pads.size() != node.pads.size())
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < node.pads.size(); ++i)
+            {
+                const NodePadType& expected = type->pads[i];
+                const NodePad* pad = node.pads[i];
+
+                if (pad->name != expected.name || pad->access != expected.access || pad->format != expected.format)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        };
+
+        writer.Key("nodes");
+        writer.StartArray();
+        for (Node* node : nodes_)
+        {
+            writer.StartObject();
+            writer.Key("id"); writer.Int(node->id_);
+            writer.Key("type"); writer.String(node->type_);
+            writer.Key("name"); writer.String(node->name_);
+            writer.Key("position");
+            writer.StartArray(true); writer.Number(node->position_.x); writer.Number(node->position_.y); writer.EndArray();
+            writer.Key("collapsed"); writer.Bool(node->state_ < 0);
+
+            if (node->parent_)
+            {
+                writer.Key("group"); writer.Int(node->parent_->id_);
+            }
+
+            // pads are only written for nodes that differ from their type, the rest take them from "types"
+            if (!has_type_pads(*node))
+            {
+                pad_types.clear();
+                for (size_t i = 0; !node->group_ && i < node->pads.size(); ++i)
+                {
+                    pad_types.push_back({ node->pads[i]->name, node->pads[i]->access, node->pads[i]->format });
+                }
+                WritePadTypes(writer, pad_types);
+            }
+
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        ////////////////////////////////////////////////////////////////////////////////
+
+        auto write_endpoint = [&writer](const char* key, const NodePad* pad)
+        {
+            const std::vector<NodePad*>& pads = pad->owner->pads;
+
+            writer.Key(key);
+            writer.StartArray(true);
+            writer.Int(pad->owner->id_);
+            writer.Int(std::find(pads.begin(), pads.end(), pad) - pads.begin());
+            writer.EndArray();
+        };
+
+        writer.Key("links");
+        writer.StartArray();
+        for (NodePadLink* link : node_links)
+        {
+            writer.StartObject();
+            write_endpoint("source", link->source);
+            write_endpoint("sink", link->sink);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.EndObject();
+
+        file.flush();
+        return (bool)file;
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // every container knows where it sits in the schema, anything unknown is skipped
+    struct NodeEditor::JsonImport : public JsonHandler
+    {
+        enum Context
+        {
+            Context_Skip,
+            Context_Document,
+            Context_Root,
+            Context_View,
+            Context_ViewScroll,
+            Context_Types,
+            Context_Type,
+            Context_TypePads,
+            Context_TypePad,
+            Context_Nodes,
+            Context_Node,
+            Context_NodePosition,
+            Context_NodePads,
+            Context_NodePad,
+            Context_Links,
+            Context_Link,
+            Context_LinkSource,
+            Context_LinkSink
+        };
+
+        struct Scope
+        {
+            Context context;
+            int index;      // element count in arrays
+        };
+
+        NodeEditor& editor;
+        std::vector<Scope> scopes;
+        std::string key;
+
+        std::unordered_map<std::string, NodeType> types;
+        NodeType type;
+        NodePadType pad;
+
+        // the file is only read into a subgraph, the editor is left alone until all of it checks out;
+        // strings are interned in its table, a node costs one record and each pad of its own one more
+        NodeSubgraph graph;
+        std::unordered_map<int32_t, uint32_t> node_index;   // id -> graph.nodes
+        std::vector<uint32_t> typed_nodes;                  // nodes without pads of their own, see ResolveTypes
+
+        // node being read, its pads go straight to graph.pads
+        GraphFileNode node;
+        bool node_has_pads;
+        int32_t node_group;
+
+        NodeSubgraphLink link;
+
+        ImVec2 scroll;
+        float scale;
+        std::string error;
+
+        explicit JsonImport(NodeEditor& editor) : editor(editor), node_has_pads(false), node_group(0), scroll(0.0f, 0.0f), scale(1.0f)
+        {
+            scopes.push_back({ Context_Document, 0 });
+        }
+
+        bool Fail(const char* message)
+        {
+            error = message;
+            return false;
+        }
+
+        // node ids and pad indices, a number that is not a whole one in [min, max] fails the import
+        template <typename T>
+        bool Integer(double number, int32_t min, int32_t max, T& out)
+        {
+            if (!(number >= min && number <= max) || number != std::floor(number))
+            {
+                return Fail("invalid node id or pad index");
+            }
+
+            out = (T)number;
+            return true;
+        }
+
+        void AddPad(const NodePadType& type)
+        {
+            GraphFilePad record;
+            memset(&record, 0, sizeof(record));
+            record.name = graph.AddString(type.name);
+            record.access = graph.AddString(type.access);
+            record.format = graph.AddString(type.format);
+
+            graph.pads.push_back(record);
+        }
+
+        Context ChildContext(bool array) const
+        {
+            const Scope& parent = scopes.back();
+
+            switch (parent.context)
+            {
+                case Context_Document: return array ? Context_Skip : Context_Root;
+                case Context_Root:
+                    if (key == "view" && !array) return Context_View;
+                    if (key == "types" && array) return Context_Types;
+                    if (key == "nodes" && array) return Context_Nodes;
+                    if (key == "links" && array) return Context_Links;
+                    break;
+                case Context_View: if (key == "scroll" && array) return Context_ViewScroll; break;
+                case Context_Types: if (!array) return Context_Type; break;
+                case Context_Type: if (key == "pads" && array) return Context_TypePads; break;
+                case Context_TypePads: if (!array) return Context_TypePad; break;
+                case Context_Nodes: if (!array) return Context_Node; break;
+                case Context_Node:
+                    if (key == "position" && array) return Context_NodePosition;
+                    if (key == "pads" && array) return Context_NodePads;
+                    break;
+                case Context_NodePads: if (!array) return Context_NodePad; break;
+                case Context_Links: if (!array) return Context_Link; break;
+                case Context_Link:
+                    if (key == "source" && array) return Context_LinkSource;
+                    if (key == "sink" && array) return Context_LinkSink;
+                    break;
+                default: break;
+            }
+
+            return Context_Skip;
+        }
+
+        bool Start(bool array)
+        {
+            const Context context = ChildContext(array);
+
+            switch (context)
+            {
+                case Context_Type: type = NodeType(); break;
+                case Context_TypePad:
+                case Context_NodePad: pad = NodePadType(); break;
+                case Context_Node:
+                    // a size of zero has CreateNodes lay the node out
+                    memset(&node, 0, sizeof(node));
+                    node.state = NodeStateFlag_Default;
+                    node.name = node.type = graph.AddString(std::string());
+                    node.first_pad = (uint32_t)graph.pads.size();
+                    node_has_pads = false;
+                    node_group = 0;
+                    break;
+                case Context_NodePads: node_has_pads = true; break;
+                case Context_Link: link = { 0, 0, 0, 0 }; break;
+                default: break;
+            }
+
+            scopes.push_back({ context, 0 });
+            return true;
+        }
+
+        bool End()
+        {
+            const Context context = scopes.back().context;
+            scopes.pop_back();
+            ++scopes.back().index;
+
+            switch (context)
+            {
+                case Context_Type: types[type.name] = type; break;
+                case Context_TypePad: type.pads.push_back(pad); break;
+                case Context_NodePad: AddPad(pad); break;
+                case Context_Node: return AddNode();
+                case Context_Link: graph.links.push_back(link); break;
+                default: break;
+            }
+
+            return true;
+        }
+
+        // positions and the view scroll, anything the grids and the layout cannot take fails the import
+        bool Coordinate(double number, float& out)
+        {
+            if (!std::isfinite(number) || std::fabs(number) > graph_file_max_extent_)
+            {
+                return Fail("invalid coordinate");
+            }
+
+            out = (float)number;
+            return true;
+        }
+
+        bool Value(const std::string* text, double number, bool flag)
+        {
+            Scope& scope = scopes.back();
+            const int index = scope.index++;
+
+            switch (scope.context)
+            {
+                case Context_Root:
+                    if (key == "version" && !text && number > graph_json_version_) return Fail("unsupported version");
+                    break;
+                case Context_View: if (key == "scale" && !text) scale = (float)ImClamp(number, 0.0, 3.0); break;
+                case Context_ViewScroll: if (index < 2 && !text) return Coordinate(number, index ? scroll.y : scroll.x); break;
+                case Context_Type: if (key == "name" && text) type.name = *text; break;
+                case Context_TypePad:
+                case Context_NodePad:
+                    if (!text) break;
+                    if (key == "name") pad.name = *text;
+                    else if (key == "access") pad.access = *text;
+                    else if (key == "format") pad.format = *text;
+                    break;
+                case Context_Node:
+                    if (key == "id" && !text) return Integer(number, 1, graph_file_max_id_, node.id);
+                    else if (key == "type" && text) node.type = graph.AddString(*text);
+                    else if (key == "name" && text) node.name = graph.AddString(*text);
+                    else if (key == "collapsed" && !text) node.state = flag ? -NodeStateFlag_Default : NodeStateFlag_Default;
+                    else if (key == "group" && !text) return Integer(number, 1, graph_file_max_id_, node_group);
+                    break;
+                case Context_NodePosition: if (index < 2 && !text) return Coordinate(number, node.position[index]); break;
+                case Context_LinkSource:
+                    if (index == 0 && !text) return Integer(number, 1, graph_file_max_id_, link.source);
+                    if (index == 1 && !text) return Integer(number, 0, INT32_MAX, link.source_pad);
+                    break;
+                case Context_LinkSink:
+                    if (index == 0 && !text) return Integer(number, 1, graph_file_max_id_, link.sink);
+                    if (index == 1 && !text) return Integer(number, 0, INT32_MAX, link.sink_pad);
+                    break;
+                default: break;
+            }
+
+            return true;
+        }
+
+        bool AddNode()
+        {
+            if (node.id <= 0 || node_index.count(node.id))
+            {
+                return Fail("missing or duplicate node id");
+            }
+
+            node.pad_count = (uint32_t)graph.pads.size() - node.first_pad;
+
+            // a group's pads are proxies made from its members, pads of its own would be destroyed under their links
+            const bool group = strcmp(graph.GetStrings().Get(node.type), node_group_type_) == 0;
+            if (group && node.pad_count)
+            {
+                return Fail("group node with pads");
+            }
+
+            if (!node_has_pads && !group)
+            {
+                typed_nodes.push_back((uint32_t)graph.nodes.size());
+            }
+
+            node_index.emplace(node.id, (uint32_t)graph.nodes.size());
+            graph.nodes.push_back(node);
+
+            if (node_group > 0)
+            {
+                graph.members.push_back({ node.id, node_group });
+            }
+
+            return true;
+        }
+
+        // a node without pads of its own takes them from its type, first from the file's "types", then
+        // from GetNodeTypes(); the pads of a type are stored once and all of its nodes share the records
+        void ResolveTypes()
+        {
+            std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> type_pads;  // type string -> first pad, count
+
+            for (uint32_t i : typed_nodes)
+            {
+                GraphFileNode& record = graph.nodes[i];
+
+                auto found = type_pads.find(record.type);
+                if (found == type_pads.end())
+                {
+                    // copied, adding strings moves the table
+                    const std::string name = graph.GetStrings().Get(record.type);
+                    const uint32_t first = (uint32_t)graph.pads.size();
+
+                    auto it = types.find(name);
+                    const NodeType* known = it != types.end() ? &it->second : GetNodeTypes().Find(name);
+
+                    for (size_t p = 0; known && p < known->pads.size(); ++p)
+                    {
+                        AddPad(known->pads[p]);
+                    }
+
+                    found = type_pads.emplace(record.type, std::make_pair(first, (uint32_t)graph.pads.size() - first)).first;
+                }
+
+                record.first_pad = found->second.first;
+                record.pad_count = found->second.second;
+            }
+        }
+
+        uint32_t FindLinkNode(int32_t node_id, uint32_t pad_index) const
+        {
+            auto it = node_index.find(node_id);
+            if (it == node_index.end() || pad_index >= graph.nodes[it->second].pad_count)
+            {
+                return UINT32_MAX;
+            }
+
+            return it->second;
+        }
+
+        // links may reference nodes that come later in the file, so they are resolved once it is read;
+        // one Kahn pass over them, links forming a cycle fail the import
+        bool Resolve()
+        {
+            ResolveTypes();
+
+            const size_t node_count = graph.nodes.size();
+
+            std::vector<uint32_t> first_out(node_count + 1, 0);
+            std::vector<uint32_t> incoming(node_count, 0);
+            std::vector<uint32_t> ends;     // source and sink node index of each link kept
+            ends.reserve(graph.links.size() * 2);
+
+            // access and format strings are resolved once each, pads share a handful of them
+            const NodeStrings strings = graph.GetStrings();
+            NodeFormatTable& formats = GetNodeFormats();
+            std::vector<uint32_t> string_access(graph.string_offsets.size(), UINT32_MAX);
+            std::vector<int32_t> string_format(graph.string_offsets.size(), -1);
+
+            auto pad_access = [&](const GraphFilePad& pad)
+            {
+                uint32_t& flags = string_access[pad.access];
+                if (flags == UINT32_MAX)
+                {
+                    flags = ParseNodePadAccess(strings.Get(pad.access));
+                }
+                return flags;
+            };
+
+            auto pad_format = [&](const GraphFilePad& pad)
+            {
+                int32_t& format = string_format[pad.format];
+                if (format < 0)
+                {
+                    format = formats.Intern(strings.Get(pad.format));
+                }
+                return (NodeFormatId)format;
+            };
+
+            // every format is interned up front, a file that runs the table out of ids fails the import
+            for (const GraphFilePad& pad : graph.pads)
+            {
+                if (pad_format(pad) == NodeFormat_Invalid)
+                {
+                    return Fail("too many pad formats");
+                }
+            }
+
+            // links to a missing node or pad are left out, a link the editor would not let the user draw fails the import
+            size_t kept = 0;
+            for (const NodeSubgraphLink& pending : graph.links)
+            {
+                const uint32_t source = FindLinkNode(pending.source, pending.source_pad);
+                const uint32_t sink = FindLinkNode(pending.sink, pending.sink_pad);
+
+                if (source == UINT32_MAX || sink == UINT32_MAX)
+                {
+                    continue;
+                }
+
+                const GraphFilePad& source_pad = graph.pads[graph.nodes[source].first_pad + pending.source_pad];
+                const GraphFilePad& sink_pad = graph.pads[graph.nodes[sink].first_pad + pending.sink_pad];
+
+                if (!formats.CanLink(pad_access(source_pad), pad_format(source_pad), pad_access(sink_pad), pad_format(sink_pad)))
+                {
+                    return Fail("link between pads that cannot be linked");
+                }
+
+                graph.links[kept++] = pending;
+                ends.push_back(source);
+                ends.push_back(sink);
+
+                ++first_out[source + 1];
+                ++incoming[sink];
+            }
+            graph.links.resize(kept);
+
+            for (size_t i = 0; i < node_count; ++i)
+            {
+                first_out[i + 1] += first_out[i];
+            }
+
+            std::vector<uint32_t> sinks(first_out.back());
+            std::vector<uint32_t> fill(first_out.begin(), first_out.end() - 1);
+
+            for (size_t l = 0; l < ends.size(); l += 2)
+            {
+                sinks[fill[ends[l]]++] = ends[l + 1];
+            }
+
+            std::vector<uint32_t> queue;
+            queue.reserve(node_count);
+            for (uint32_t i = 0; i < (uint32_t)node_count; ++i)
+            {
+                if (incoming[i] == 0)
+                {
+                    queue.push_back(i);
+                }
+            }
+
+            for (size_t head = 0; head < queue.size(); ++head)
+            {
+                for (uint32_t l = first_out[queue[head]]; l < first_out[queue[head] + 1]; ++l)
+                {
+                    if (--incoming[sinks[l]] == 0)
+                    {
+                        queue.push_back(sinks[l]);
+                    }
+                }
+            }
+
+            if (queue.size() != node_count)
+            {
+                return Fail("links form a cycle");
+            }
+
+            return true;
+        }
+
+        // the same path as pasting: nodes are laid out by CreateNodes, a big batch of links is attached
+        // as is and ordered in one pass (Resolve made sure it is acyclic), then groups get their members
+        void Build()
+        {
+            std::vector<Node*> created;
+            editor.InsertSubgraph(graph, ImVec2(0.0f, 0.0f), false, created);
+            editor.UpdateGroups();
+        }
+
+        bool StartObject() override { return Start(false); }
+        bool EndObject() override { return End(); }
+        bool StartArray() override { return Start(true); }
+        bool EndArray() override { return End(); }
+        bool Key(const std::string& value) override { key = value; return true; }
+        bool String(const std::string& value) override { return Value(&value, 0.0, false); }
+        bool Number(double value) override { return Value(nullptr, value, false); }
+        bool Bool(bool value) override { return Value(nullptr, 0.0, value); }
+        bool Null() override { return Value(nullptr, 0.0, false); }
+    };
+
+    bool NodeEditor::ImportJson(const std::string& path, const JsonProgress& progress)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            return false;
+        }
+
+        const uint64_t total = (uint64_t)file.tellg();
+        file.seekg(0);
+
+        JsonImport import(*this);
+        JsonReader reader;
+
+        // the whole file is read and checked before the current graph is touched
+        if (!reader.Parse(file, import, total, progress) || !import.Resolve())
+        {
+            return false;
+        }
+
+        ClearGraph();
+        import.Build();
+
+        // keep nodes_ in id order, the file may list them in any order
+        std::sort(nodes_.begin(), nodes_.end(), [](const Node* a, const Node* b) { return a->id_ < b->id_; });
+        for (size_t i = 0; i < nodes_.size(); ++i)
+        {
+            nodes_[i]->index_ = i;
+        }
+
+        canvas_scroll_ = import.scroll;
+        canvas_scale_ = import.scale > 0.0f ? ImClamp(import.scale, 0.3f, 3.0f) : 1.0f;
+
+        return true;
+    }
+}
@@ -0,0 +1,104 @@
+// Streaming JSON reader and writer for the node graph editor
+//
+// The reader is event based (SAX style): it never builds a document, values are
+// handed to a JsonHandler as soon as they are parsed, so memory use does not
+// depend on the size of the input. The writer emits tokens straight to a stream.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    // return false from any event to stop parsing
+    class JsonHandler
+    {
+    public:
+        virtual ~JsonHandler() {}
+
+        virtual bool StartObject() { return true; }
+        virtual bool EndObject() { return true; }
+        virtual bool StartArray() { return true; }
+        virtual bool EndArray() { return true; }
+        virtual bool Key(const std::string& key) { (void)key; return true; }
+        virtual bool String(const std::string& value) { (void)value; return true; }
+        virtual bool Number(double value) { (void)value; return true; }
+        virtual bool Bool(bool value) { (void)value; return true; }
+        virtual bool Null() { return true; }
+    };
+
+    // bytes consumed so far and total input size (0 if unknown)
+    typedef std::function<void(uint64_t read, uint64_t total)> JsonProgress;
+
+    class JsonReader
+    {
+        std::istream* in_;
+        std::vector<char> buffer_;
+        size_t pos_;
+        size_t end_;
+        uint64_t consumed_;
+        uint64_t total_;
+        JsonProgress progress_;
+
+        std::string error_;
+        std::string token_;
+
+        int Peek();
+        int Get();
+        bool Refill();
+        bool SkipWhitespace();
+        bool ParseString(std::string& out);
+        bool ParseNumber(double& out);
+        bool ParseLiteral(const char* literal);
+        bool Fail(const char* message);
+
+    public:
+        JsonReader();
+
+        bool Parse(std::istream& in, JsonHandler& handler, uint64_t total = 0, const JsonProgress& progress = JsonProgress());
+
+        const std::string& GetError() const { return error_; }
+        uint64_t GetOffset() const { return consumed_ + pos_; }
+    };
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    class JsonWriter
+    {
+        struct Scope
+        {
+            bool array;
+            bool compact;   // keep all elements on one line
+            bool empty;
+        };
+
+        std::ostream& out_;
+        std::vector<Scope> scopes_;
+        bool after_key_;
+
+        void BeginValue();
+        void NewLine();
+        void WriteEscaped(const std::string& value);
+
+    public:
+        explicit JsonWriter(std::ostream& out);
+
+        void StartObject();
+        void EndObject();
+        void StartArray(bool compact = false);
+        void EndArray();
+        void Key(const std::string& key);
+        void String(const std::string& value);
+        void Number(double value);
+        void Int(int64_t value);
+        void Bool(bool value);
+        void Null();
+    };
+}
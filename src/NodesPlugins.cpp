@@ -0,0 +1,152 @@
+// Node libraries for the node graph editor
+
+#include "NodesPlugins.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <dlfcn.h>
+#endif
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+    static const char* const plugin_suffix_ = ".dll";
+#elif defined(__APPLE__)
+    static const char* const plugin_suffix_ = ".dylib";
+#else
+    static const char* const plugin_suffix_ = ".so";
+#endif
+
+    // paths of the libraries loaded so far, they are never closed
+    static std::unordered_set<std::string>& LoadedPlugins()
+    {
+        static std::unordered_set<std::string> loaded;
+        return loaded;
+    }
+
+    static bool Fail(std::string* error, const std::string& path, const std::string& reason)
+    {
+        if (error)
+        {
+            *error = path + ": " + reason;
+        }
+        return false;
+    }
+
+    bool LoadNodePlugin(const std::string& path, const NodePluginApi& api, std::string* error)
+    {
+        if (LoadedPlugins().count(path))
+        {
+            return Fail(error, path, "already loaded");
+        }
+
+#ifdef _WIN32
+        HMODULE library = LoadLibraryA(path.c_str());
+        if (!library)
+        {
+            return Fail(error, path, "cannot be opened, error " + std::to_string(GetLastError()));
+        }
+
+        NodePluginEntry entry = (NodePluginEntry)GetProcAddress(library, NodePlugin_EntryName);
+        if (!entry)
+        {
+            FreeLibrary(library);
+            return Fail(error, path, std::string("does not export ") + NodePlugin_EntryName);
+        }
+#else
+        void* library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!library)
+        {
+            const char* reason = dlerror();
+            return Fail(error, path, reason ? reason : "cannot be opened");
+        }
+
+        NodePluginEntry entry = (NodePluginEntry)dlsym(library, NodePlugin_EntryName);
+        if (!entry)
+        {
+            dlclose(library);
+            return Fail(error, path, std::string("does not export ") + NodePlugin_EntryName);
+        }
+#endif
+
+        // the library stays loaded even when it refuses, it may have registered some types already
+        LoadedPlugins().insert(path);
+
+        if (!entry(api))
+        {
+            return Fail(error, path, "refused to register");
+        }
+
+        return true;
+    }
+
+    size_t LoadNodePlugins(const std::string& directory, const NodePluginApi& api, std::vector<std::string>* errors)
+    {
+        std::vector<std::string> paths;
+        const std::string suffix = plugin_suffix_;
+
+#ifdef _WIN32
+        WIN32_FIND_DATAA found;
+        HANDLE search = FindFirstFileA((directory + "\\*" + suffix).c_str(), &found);
+        if (search != INVALID_HANDLE_VALUE)
+        {
+            do
+            {
+                if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+                {
+                    paths.push_back(directory + "\\" + found.cFileName);
+                }
+            }
+            while (FindNextFileA(search, &found));
+
+            FindClose(search);
+        }
+#else
+        DIR* dir = opendir(directory.c_str());
+        if (dir)
+        {
+            while (const dirent* entry = readdir(dir))
+            {
+                const std::string name = entry->d_name;
+                if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+                {
+                    paths.push_back(directory + "/" + name);
+                }
+            }
+
+            closedir(dir);
+        }
+#endif
+
+        std::sort(paths.begin(), paths.end());
+
+        size_t loaded = 0;
+        for (const std::string& path : paths)
+        {
+            if (LoadedPlugins().count(path))
+            {
+                continue;
+            }
+
+            std::string error;
+            if (LoadNodePlugin(path, api, &error))
+            {
+                ++loaded;
+            }
+            else if (errors)
+            {
+                errors->push_back(error);
+            }
+        }
+
+        return loaded;
+    }
+}
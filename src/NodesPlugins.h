@@ -0,0 +1,52 @@
+// Node libraries for the node graph editor
+//
+// A node library is a shared object (.so, .dylib or .dll) exporting
+//
+//   extern "C" bool ofNodeEditRegister(const ImGui::NodePluginApi& api)
+//
+// which registers node types, and their implementations when the editor runs
+// the graph, through the registries it is given. Registering only runs code
+// from the headers, so the editor does not have to export its symbols. Types
+// are handed over as C++ objects: a library has to be built with the same
+// compiler and headers as the editor; it can check api.version and return
+// false to be skipped.
+//
+// Libraries stay loaded until the program exits, their processors may be
+// running on the runtime thread at any time.
+
+#pragma once
+
+#include "NodesTypes.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    class NodeProcessorRegistry;
+
+    static const uint32_t NodePluginApi_Version = 1;
+
+    struct NodePluginApi
+    {
+        uint32_t version;                   // NodePluginApi_Version of the editor
+        NodeTypeRegistry* types;
+        NodeProcessorRegistry* processors;  // null when the graph is not executed
+    };
+
+    typedef bool (*NodePluginEntry)(const NodePluginApi& api);
+
+    static const char* const NodePlugin_EntryName = "ofNodeEditRegister";
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // false with a reason in error when the library cannot be opened, has no entry point or
+    // refuses to register; a library that is already loaded is not loaded again
+    bool LoadNodePlugin(const std::string& path, const NodePluginApi& api, std::string* error = nullptr);
+
+    // every library in directory not loaded yet, in name order; returns how many were loaded, one error per failure
+    size_t LoadNodePlugins(const std::string& directory, const NodePluginApi& api, std::vector<std::string>* errors = nullptr);
+}
@@ -0,0 +1,135 @@
+// Typed pool allocator for the node graph editor
+//
+// Objects are constructed in place inside fixed size chunks, so their addresses
+// stay stable, objects created together sit next to each other in memory and
+// the whole pool can be reset in one go without freeing the chunks.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T, size_t ChunkSize = 256>
+    class NodePool
+    {
+        struct Slot
+        {
+            alignas(T) unsigned char storage[sizeof(T)];
+            Slot* next;     // free list link
+            bool live;
+        };
+
+        struct Chunk
+        {
+            Slot slots[ChunkSize];
+        };
+
+        std::vector<std::unique_ptr<Chunk>> chunks_;
+        size_t chunk_;      // chunk currently bump allocated from
+        size_t used_;       // slots handed out from chunks_[chunk_]
+        size_t size_;       // live objects
+        Slot* free_;
+
+        Slot* Acquire()
+        {
+            if (free_)
+            {
+                Slot* slot = free_;
+                free_ = slot->next;
+                return slot;
+            }
+
+            if (chunks_.empty() || used_ == ChunkSize)
+            {
+                if (!chunks_.empty())
+                {
+                    ++chunk_;
+                }
+
+                if (chunk_ == chunks_.size())
+                {
+                    chunks_.emplace_back(new Chunk());
+                }
+
+                used_ = 0;
+            }
+
+            return &chunks_[chunk_]->slots[used_++];
+        }
+
+    public:
+        NodePool() : chunk_(0), used_(0), size_(0), free_(nullptr) {}
+        ~NodePool() { Clear(); }
+
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        size_t Size() const { return size_; }
+
+        // make sure count more objects can be created without allocating chunks one by one
+        void Reserve(size_t count)
+        {
+            const size_t available = chunks_.empty() ? 0 : (chunks_.size() - chunk_) * ChunkSize - used_;
+
+            for (size_t i = available; i < count; i += ChunkSize)
+            {
+                chunks_.emplace_back(new Chunk());
+            }
+        }
+
+        template<typename... Args>
+        T* Create(Args&&... args)
+        {
+            Slot* slot = Acquire();
+            T* object = new (slot->storage) T(std::forward<Args>(args)...);
+            slot->live = true;
+            ++size_;
+            return object;
+        }
+
+        void Destroy(T* object)
+        {
+            if (!object) return;
+
+            object->~T();
+
+            // storage is the first member, so the object address is the slot address
+            Slot* slot = reinterpret_cast<Slot*>(reinterpret_cast<unsigned char*>(object) - offsetof(Slot, storage));
+            slot->live = false;
+            slot->next = free_;
+            free_ = slot;
+            --size_;
+        }
+
+        // destroy every live object and rewind to the first chunk, keeping the memory
+        void Clear()
+        {
+            for (size_t c = 0; c < chunks_.size() && c <= chunk_; ++c)
+            {
+                const size_t count = c == chunk_ ? used_ : ChunkSize;
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    Slot& slot = chunks_[c]->slots[i];
+                    if (slot.live)
+                    {
+                        reinterpret_cast<T*>(slot.storage)->~T();
+                        slot.live = false;
+                    }
+                }
+            }
+
+            chunk_ = 0;
+            used_ = 0;
+            size_ = 0;
+            free_ = nullptr;
+        }
+    };
+}
@@ -0,0 +1,172 @@
+// Per phase frame profiler for the node graph editor
+
+#include "NodesProfiler.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    NodeProfiler::NodeProfiler() : head_(0), frames_(0)
+    {
+        for (auto& phase : phases_)
+        {
+            phase = Phase();
+        }
+    }
+
+    void NodeProfiler::BeginFrame()
+    {
+        // phases that do not run this frame count as zero
+        for (auto& phase : phases_)
+        {
+            phase.samples[head_] = 0.0f;
+            phase.vertices = phase.indices = phase.commands = 0;
+        }
+
+        Begin(NodeProfilePhase_Frame, nullptr);
+    }
+
+    void NodeProfiler::EndFrame()
+    {
+        End(NodeProfilePhase_Frame);
+
+        // the frame spans several draw lists, report what its phases added
+        Phase& frame = phases_[NodeProfilePhase_Frame];
+        for (int i = 0; i < NodeProfilePhase_Frame; ++i)
+        {
+            frame.vertices += phases_[i].vertices;
+            frame.indices += phases_[i].indices;
+            frame.commands += phases_[i].commands;
+        }
+
+        head_ = (head_ + 1) % Window;
+        frames_ = std::min(frames_ + 1, (int)Window);
+    }
+
+    void NodeProfiler::Begin(NodeProfilePhase phase, const ImDrawList* draw_list)
+    {
+        Phase& p = phases_[phase];
+        p.draw_list = draw_list;
+
+        if (draw_list)
+        {
+            p.vertices -= draw_list->VtxBuffer.Size;
+            p.indices -= draw_list->IdxBuffer.Size;
+            p.commands -= draw_list->CmdBuffer.Size;
+        }
+
+        p.start = Clock::now();
+    }
+
+    void NodeProfiler::End(NodeProfilePhase phase)
+    {
+        const Clock::time_point end = Clock::now();
+
+        Phase& p = phases_[phase];
+        p.samples[head_] += std::chrono::duration<float, std::milli>(end - p.start).count();
+
+        if (p.draw_list)
+        {
+            p.vertices += p.draw_list->VtxBuffer.Size;
+            p.indices += p.draw_list->IdxBuffer.Size;
+            p.commands += p.draw_list->CmdBuffer.Size;
+        }
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    NodeProfileStats NodeProfiler::GetStats(NodeProfilePhase phase) const
+    {
+        const Phase& p = phases_[phase];
+
+        NodeProfileStats stats = NodeProfileStats();
+
+        stats.frames = frames_;
+        stats.vertices = p.vertices;
+        stats.indices = p.indices;
+        stats.commands = p.commands;
+
+        if (frames_ == 0)
+        {
+            return stats;
+        }
+
+        float sorted[Window] = {};
+        const int count = GetSamples(phase, sorted, Window);
+        if (count <= 0)
+        {
+            return stats;
+        }
+
+        stats.last_ms = sorted[count - 1];
+
+        float sum = 0.0f;
+        for (int i = 0; i < count; ++i)
+        {
+            sum += sorted[i];
+        }
+        stats.avg_ms = sum / count;
+
+        // p99 only needs its own rank in place, the rest stays unordered
+        const int rank = std::min(count - 1, (count * 99) / 100);
+        std::nth_element(sorted, sorted + rank, sorted + count);
+        stats.p99_ms = sorted[rank];
+        stats.min_ms = *std::min_element(sorted, sorted + count);
+
+        return stats;
+    }
+
+    int NodeProfiler::GetSamples(NodeProfilePhase phase, float* out, int count) const
+    {
+        const Phase& p = phases_[phase];
+        count = std::min(count, frames_);
+
+        // head_ is the next slot to write, so the newest sample sits right before it
+        for (int i = 0; i < count; ++i)
+        {
+            out[i] = p.samples[(head_ - count + i + Window) % Window];
+        }
+
+        return count;
+    }
+
+    const char* NodeProfiler::GetPhaseName(NodeProfilePhase phase)
+    {
+        switch (phase)
+        {
+            case NodeProfilePhase_Grid: return "Grid";
+            case NodeProfilePhase_UpdateState: return "UpdateState";
+            case NodeProfilePhase_RenderLines: return "RenderLines";
+            case NodeProfilePhase_DisplayNodes: return "DisplayNodes";
+            case NodeProfilePhase_ContextMenu: return "ContextMenu";
+            case NodeProfilePhase_Frame: return "Frame";
+            default: return "UNKNOWN";
+        }
+    }
+
+    void NodeProfiler::DrawOverlay() const
+    {
+        ImGui::Text("%-13s %7s %7s %7s %7s %8s %8s %5s", "phase (ms)", "last", "min", "avg", "p99", "vtx", "idx", "cmd");
+
+        for (int i = 0; i < NodeProfilePhase_COUNT; ++i)
+        {
+            const NodeProfilePhase phase = (NodeProfilePhase)i;
+            const NodeProfileStats stats = GetStats(phase);
+
+            if (phase == NodeProfilePhase_Frame)
+            {
+                ImGui::Separator();
+            }
+
+            ImGui::Text("%-13s %7.3f %7.3f %7.3f %7.3f %8d %8d %5d", GetPhaseName(phase),
+                stats.last_ms, stats.min_ms, stats.avg_ms, stats.p99_ms, stats.vertices, stats.indices, stats.commands);
+        }
+
+        float samples[Window];
+        const int count = GetSamples(NodeProfilePhase_Frame, samples, Window);
+        ImGui::PlotHistogram("##frame", samples, count, 0, "frame", 0.0f, FLT_MAX, ImVec2(0.0f, 48.0f));
+    }
+}
@@ -0,0 +1,85 @@
+// Per phase frame profiler for the node graph editor
+//
+// ProcessNodes brackets each of its phases with Begin/End. Every phase keeps a
+// rolling window of timings, and the growth of the draw list it recorded into,
+// so the overlay can show where a frame goes on a real patch.
+
+#pragma once
+
+#include "imgui.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    enum NodeProfilePhase
+    {
+        NodeProfilePhase_Grid = 0,
+        NodeProfilePhase_UpdateState,
+        NodeProfilePhase_RenderLines,
+        NodeProfilePhase_DisplayNodes,
+        NodeProfilePhase_ContextMenu,
+        NodeProfilePhase_Frame,         // the whole of ProcessNodes
+        NodeProfilePhase_COUNT
+    };
+
+    struct NodeProfileStats
+    {
+        float last_ms;
+        float min_ms;
+        float avg_ms;
+        float p99_ms;
+        int frames;             // samples in the window
+
+        // draw list growth during the last frame
+        int vertices;
+        int indices;
+        int commands;
+    };
+
+    class NodeProfiler
+    {
+    public:
+        enum { Window = 256 };  // frames kept per phase
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Phase
+        {
+            float samples[Window];  // milliseconds, ring buffer
+            Clock::time_point start;
+            const ImDrawList* draw_list;
+            int vertices;
+            int indices;
+            int commands;
+        };
+
+        Phase phases_[NodeProfilePhase_COUNT];
+        int head_;      // slot written this frame
+        int frames_;    // valid slots, up to Window
+
+    public:
+        NodeProfiler();
+
+        void BeginFrame();
+        void EndFrame();
+
+        void Begin(NodeProfilePhase phase, const ImDrawList* draw_list);
+        void End(NodeProfilePhase phase);
+
+        // min, avg and p99 over the window; last_ms and the draw counts from the latest frame
+        NodeProfileStats GetStats(NodeProfilePhase phase) const;
+
+        // oldest first, for plotting
+        int GetSamples(NodeProfilePhase phase, float* out, int count) const;
+
+        static const char* GetPhaseName(NodeProfilePhase phase);
+
+        // table of every phase plus a histogram of frame times, drawn into the current window
+        void DrawOverlay() const;
+    };
+}
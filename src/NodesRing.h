@@ -0,0 +1,149 @@
+// Lock free single producer, single consumer ring buffer for the node graph runtime
+//
+// A NodePadLink has exactly one source and one sink, so a buffered link needs
+// no more than this. Slots are constructed once and reused, the producer
+// fills a slot in place between Reserve and Commit, the consumer reads it in
+// place between Front and Release, nothing is copied or allocated per value.
+//
+// The producer and consumer indices sit on separate cache lines, together
+// with a private copy of the other side's index, so in the common case each
+// side only touches memory it owns.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    class SpscRing
+    {
+        enum { CacheLine = 64 };
+
+        std::unique_ptr<T[]> slots_;
+        size_t mask_;
+        char pad0_[CacheLine];
+
+        // producer
+        std::atomic<size_t> head_;  // next slot to write
+        size_t tail_cache_;         // last tail_ seen by the producer
+        char pad1_[CacheLine - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+
+        // consumer
+        std::atomic<size_t> tail_;  // next slot to read
+        size_t head_cache_;         // last head_ seen by the consumer
+        char pad2_[CacheLine - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+
+    public:
+        // capacity is rounded up to a power of two
+        explicit SpscRing(size_t capacity) : head_(0), tail_cache_(0), tail_(0), head_cache_(0)
+        {
+            size_t size = 1;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+
+            slots_.reset(new T[size]);
+            mask_ = size - 1;
+        }
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        size_t Capacity() const { return mask_ + 1; }
+
+        // only while neither side is running, ie to reserve storage inside the slots up front
+        T& GetSlot(size_t index) { return slots_[index]; }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // producer
+
+        // slot to fill in place, nullptr when the ring is full
+        T* Reserve()
+        {
+            const size_t head = head_.load(std::memory_order_relaxed);
+
+            if (head - tail_cache_ > mask_)
+            {
+                tail_cache_ = tail_.load(std::memory_order_acquire);
+                if (head - tail_cache_ > mask_)
+                {
+                    return nullptr;
+                }
+            }
+
+            return &slots_[head & mask_];
+        }
+
+        // publishes the slot returned by the last Reserve
+        void Commit()
+        {
+            head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        bool Push(const T& value)
+        {
+            T* slot = Reserve();
+            if (!slot)
+            {
+                return false;
+            }
+
+            *slot = value;
+            Commit();
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // consumer
+
+        // oldest published slot, nullptr when the ring is empty
+        T* Front()
+        {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+
+            if (tail == head_cache_)
+            {
+                head_cache_ = head_.load(std::memory_order_acquire);
+                if (tail == head_cache_)
+                {
+                    return nullptr;
+                }
+            }
+
+            return &slots_[tail & mask_];
+        }
+
+        // hands the slot returned by Front back to the producer
+        void Release()
+        {
+            tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        bool Pop(T& value)
+        {
+            T* slot = Front();
+            if (!slot)
+            {
+                return false;
+            }
+
+            value = *slot;
+            Release();
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////
+
+        // exact on either side, a snapshot anywhere else
+        size_t Size() const
+        {
+            return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+        }
+    };
+}
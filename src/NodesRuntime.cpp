@@ -0,0 +1,498 @@
+// Dataflow runtime for the node graph editor
+
+#include "NodesRuntime.h"
+
+#include <algorithm>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    std::unique_ptr<NodeProcessor> NodeProcessorRegistry::Create(const std::string& type) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = factories_.find(HashNodeTypeName(type));
+        if (it == factories_.end())
+        {
+            return nullptr;
+        }
+
+        return it->second();
+    }
+
+    NodeProcessorRegistry& GetNodeProcessors()
+    {
+        static NodeProcessorRegistry processors;
+        return processors;
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    NodeRuntime::NodeRuntime() : order_dirty_(false), acyclic_count_(0), pending_nodes_(0), tick_(0), running_(false), period_(std::chrono::milliseconds(10))
+    {
+    }
+
+    NodeRuntime::~NodeRuntime()
+    {
+        Stop();
+        scheduler_.Stop();
+    }
+
+    void NodeRuntime::Push(Command&& command)
+    {
+        std::lock_guard<std::mutex> lock(commands_mutex_);
+        commands_.push_back(std::move(command));
+    }
+
+    void NodeRuntime::AddNode(int32_t id, const std::string& type, const std::vector<PadDesc>& pads)
+    {
+        Command command(Command_AddNode, id);
+        command.node_type = type;
+        command.pads = pads;
+        Push(std::move(command));
+    }
+
+    void NodeRuntime::RemoveNode(int32_t id)
+    {
+        Push(Command(Command_RemoveNode, id));
+    }
+
+    void NodeRuntime::AddLink(int32_t source_node, int32_t source_pad, int32_t sink_node, int32_t sink_pad)
+    {
+        Push(Command(Command_AddLink, source_node, source_pad, sink_node, sink_pad));
+    }
+
+    void NodeRuntime::RemoveLink(int32_t source_node, int32_t source_pad, int32_t sink_node, int32_t sink_pad)
+    {
+        Push(Command(Command_RemoveLink, source_node, source_pad, sink_node, sink_pad));
+    }
+
+    void NodeRuntime::SetLinkBuffer(NodeFormatId format, size_t frames, size_t reserve)
+    {
+        Command command(Command_SetBuffer);
+        command.format = format;
+        command.frames = frames;
+        command.reserve = reserve;
+        Push(std::move(command));
+    }
+
+    void NodeRuntime::Clear()
+    {
+        std::lock_guard<std::mutex> lock(commands_mutex_);
+
+        // nothing queued before a clear matters any more
+        commands_.clear();
+        commands_.push_back(Command(Command_Clear));
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    void NodeRuntime::ApplyCommands()
+    {
+        {
+            std::lock_guard<std::mutex> lock(commands_mutex_);
+            pending_.swap(commands_);
+        }
+
+        for (auto& command : pending_)
+        {
+            Apply(command);
+        }
+
+        // keep the capacity, edits arrive in bursts
+        pending_.clear();
+    }
+
+    void NodeRuntime::Apply(Command& command)
+    {
+        switch (command.type)
+        {
+            case Command_AddNode:
+            {
+                std::unique_ptr<RuntimeNode> node(new RuntimeNode());
+                node->id = command.node;
+                node->type = command.node_type;
+                node->pads.resize(command.pads.size());
+                for (size_t i = 0; i < command.pads.size(); ++i)
+                {
+                    node->pads[i].name = std::move(command.pads[i].name);
+                    node->pads[i].access_flags = command.pads[i].access_flags;
+                    node->pads[i].format_id = command.pads[i].format_id;
+                }
+                node->processor = GetNodeProcessors().Create(node->type);
+
+                nodes_[command.node] = std::move(node);
+                order_dirty_ = true;
+            } break;
+
+            case Command_RemoveNode:
+            {
+                auto it = nodes_.find(command.node);
+                if (it == nodes_.end()) break;
+
+                RuntimeNode* node = it->second.get();
+                while (!node->links_in.empty()) RemoveLink(node->links_in.back());
+                while (!node->links_out.empty()) RemoveLink(node->links_out.back());
+
+                nodes_.erase(it);
+                order_dirty_ = true;
+            } break;
+
+            case Command_AddLink:
+            {
+                RuntimePad* source;
+                RuntimePad* sink;
+                if (!FindPads(command, source, sink)) break;
+
+                std::unique_ptr<RuntimeLink> link(new RuntimeLink());
+                link->source_node = nodes_[command.node].get();
+                link->sink_node = nodes_[command.sink_node].get();
+                link->source = source;
+                link->sink = sink;
+
+                auto buffer = buffers_.find(source->format_id);
+                if (buffer != buffers_.end())
+                {
+                    // every slot gets its storage now, the ring never allocates once running
+                    link->ring.reset(new NodeValueRing(buffer->second.frames));
+                    for (size_t i = 0; i < link->ring->Capacity(); ++i)
+                    {
+                        link->ring->GetSlot(i).numbers.reserve(buffer->second.reserve);
+                    }
+                }
+
+                link->source->links_out.push_back(link.get());
+                link->source_node->links_out.push_back(link.get());
+                link->sink_node->links_in.push_back(link.get());
+                links_.push_back(std::move(link));
+                order_dirty_ = true;
+            } break;
+
+            case Command_RemoveLink:
+            {
+                RuntimePad* source;
+                RuntimePad* sink;
+                if (!FindPads(command, source, sink)) break;
+
+                for (RuntimeLink* link : source->links_out)
+                {
+                    if (link->sink == sink)
+                    {
+                        RemoveLink(link);
+                        break;
+                    }
+                }
+                order_dirty_ = true;
+            } break;
+
+            case Command_SetBuffer:
+                if (command.frames > 0)
+                {
+                    buffers_[command.format] = { command.frames, command.reserve };
+                }
+                else
+                {
+                    buffers_.erase(command.format);
+                }
+                break;
+
+            case Command_Clear:
+                order_.clear();
+                roots_.clear();
+                acyclic_count_ = 0;
+                links_.clear();
+                nodes_.clear();
+                order_dirty_ = false;
+                break;
+        }
+    }
+
+    bool NodeRuntime::FindPads(const Command& command, RuntimePad*& source, RuntimePad*& sink)
+    {
+        auto source_node = nodes_.find(command.node);
+        auto sink_node = nodes_.find(command.sink_node);
+        if (source_node == nodes_.end() || sink_node == nodes_.end())
+        {
+            return false;
+        }
+
+        std::vector<RuntimePad>& source_pads = source_node->second->pads;
+        std::vector<RuntimePad>& sink_pads = sink_node->second->pads;
+        if (command.pad < 0 || command.pad >= (int32_t)source_pads.size() || command.sink_pad < 0 || command.sink_pad >= (int32_t)sink_pads.size())
+        {
+            return false;
+        }
+
+        source = &source_pads[command.pad];
+        sink = &sink_pads[command.sink_pad];
+        return true;
+    }
+
+    void NodeRuntime::RemoveLink(RuntimeLink* link)
+    {
+        auto erase = [](std::vector<RuntimeLink*>& links, RuntimeLink* link)
+        {
+            links.erase(std::find(links.begin(), links.end(), link));
+        };
+
+        erase(link->source->links_out, link);
+        erase(link->source_node->links_out, link);
+        erase(link->sink_node->links_in, link);
+
+        auto it = std::find_if(links_.begin(), links_.end(), [link](const std::unique_ptr<RuntimeLink>& owned) { return owned.get() == link; });
+        std::swap(*it, links_.back());
+        links_.pop_back();
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // Kahn's algorithm over the direct links; nodes on a cycle, or fed by one, run last and read the previous tick's values
+    void NodeRuntime::SortNodes()
+    {
+        order_.clear();
+        order_.reserve(nodes_.size());
+
+        std::unordered_map<RuntimeNode*, size_t> remaining;
+        remaining.reserve(nodes_.size());
+
+        for (auto& entry : nodes_)
+        {
+            RuntimeNode* node = entry.second.get();
+
+            node->dependencies = 0;
+            for (RuntimeLink* link : node->links_in)
+            {
+                node->dependencies += link->ring ? 0 : 1;
+            }
+
+            remaining[node] = node->dependencies;
+            if (node->dependencies == 0)
+            {
+                order_.push_back(node);
+            }
+        }
+
+        // ties are broken by id so the order does not depend on hashing
+        std::sort(order_.begin(), order_.end(), [](const RuntimeNode* a, const RuntimeNode* b) { return a->id < b->id; });
+
+        for (size_t i = 0; i < order_.size(); ++i)
+        {
+            for (RuntimeLink* link : order_[i]->links_out)
+            {
+                if (!link->ring && --remaining[link->sink_node] == 0)
+                {
+                    order_.push_back(link->sink_node);
+                }
+            }
+        }
+
+        acyclic_count_ = order_.size();
+
+        roots_.clear();
+        for (RuntimeNode* node : order_)
+        {
+            node->cyclic = false;
+            if (node->dependencies == 0)
+            {
+                roots_.push_back(node);
+            }
+        }
+
+        if (order_.size() < nodes_.size())
+        {
+            const size_t sorted = order_.size();
+            for (auto& entry : remaining)
+            {
+                if (entry.second > 0)
+                {
+                    entry.first->cyclic = true;
+                    order_.push_back(entry.first);
+                }
+            }
+            std::sort(order_.begin() + sorted, order_.end(), [](const RuntimeNode* a, const RuntimeNode* b) { return a->id < b->id; });
+        }
+
+        order_dirty_ = false;
+    }
+
+    void NodeRuntime::Evaluate(RuntimeNode& node)
+    {
+        const uint64_t tick = tick_;
+
+        const bool drain = !node.processor || !node.processor->ReadsBuffers();
+
+        // the sink copies its inputs, so sources feeding the same pad never write concurrently;
+        // assignment reuses the sink's storage
+        for (RuntimeLink* link : node.links_in)
+        {
+            if (!link->ring)
+            {
+                link->sink->value.numbers = link->source->value.numbers;
+                link->sink->value.text = link->source->value.text;
+                link->sink->value.tick = link->source->value.tick;
+                continue;
+            }
+
+            // swapping hands the pad's old storage back to the ring
+            while (NodeValue* frame = drain ? link->ring->Front() : nullptr)
+            {
+                std::swap(link->sink->value, *frame);
+                link->ring->Release();
+            }
+        }
+
+        if (node.processor)
+        {
+            node.processor->Process(node, tick);
+        }
+
+        // queue outputs written this tick on the buffered links
+        for (RuntimeLink* link : node.links_out)
+        {
+            const NodeValue& value = link->source->value;
+            if (!link->ring || value.tick != tick)
+            {
+                continue;
+            }
+
+            NodeValue* slot = link->ring->Reserve();
+            if (!slot)
+            {
+                ++link->dropped;
+                continue;
+            }
+
+            slot->numbers = value.numbers;
+            slot->text = value.text;
+            slot->tick = value.tick;
+            link->ring->Commit();
+        }
+    }
+
+    void NodeRuntime::EvaluateTask(void* context, void* data)
+    {
+        NodeRuntime& runtime = *(NodeRuntime*)context;
+        RuntimeNode& node = *(RuntimeNode*)data;
+
+        runtime.Evaluate(node);
+
+        // release every successor whose last input this was
+        for (RuntimeLink* link : node.links_out)
+        {
+            RuntimeNode* sink = link->sink_node;
+            if (!link->ring && !sink->cyclic && sink->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                runtime.scheduler_.Submit({ &NodeRuntime::EvaluateTask, &runtime, sink });
+            }
+        }
+
+        runtime.pending_nodes_.fetch_sub(1, std::memory_order_release);
+    }
+
+    void NodeRuntime::Tick()
+    {
+        std::lock_guard<std::mutex> lock(tick_mutex_);
+
+        ApplyCommands();
+
+        if (order_dirty_)
+        {
+            SortNodes();
+        }
+
+        ++tick_;
+
+        if (scheduler_.GetWorkerCount() == 0)
+        {
+            for (RuntimeNode* node : order_)
+            {
+                Evaluate(*node);
+            }
+            return;
+        }
+
+        // the acyclic part runs as a task graph, each node released by its last input
+        for (size_t i = 0; i < acyclic_count_; ++i)
+        {
+            order_[i]->remaining.store(order_[i]->dependencies, std::memory_order_relaxed);
+        }
+        pending_nodes_.store((uint32_t)acyclic_count_, std::memory_order_release);
+
+        for (RuntimeNode* node : roots_)
+        {
+            scheduler_.Submit({ &NodeRuntime::EvaluateTask, this, node });
+        }
+
+        scheduler_.Wait(pending_nodes_);
+
+        // nodes on a cycle read each other's previous values, they run in order afterwards
+        for (size_t i = acyclic_count_; i < order_.size(); ++i)
+        {
+            Evaluate(*order_[i]);
+        }
+    }
+
+    void NodeRuntime::SetThreads(size_t workers, bool pin, int first_core)
+    {
+        // edits and ticks stay on the runtime thread, workers only ever run whole nodes
+        std::lock_guard<std::mutex> lock(tick_mutex_);
+        scheduler_.Start(workers, pin, first_core);
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    void NodeRuntime::SetTickRate(double hz)
+    {
+        std::lock_guard<std::mutex> lock(thread_mutex_);
+        period_ = std::chrono::nanoseconds((int64_t)(1e9 / std::max(hz, 1.0)));
+    }
+
+    void NodeRuntime::Start()
+    {
+        if (running_)
+        {
+            return;
+        }
+
+        running_ = true;
+        thread_ = std::thread(&NodeRuntime::Run, this);
+    }
+
+    void NodeRuntime::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(thread_mutex_);
+            running_ = false;
+        }
+        wake_.notify_all();
+
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+    }
+
+    void NodeRuntime::Run()
+    {
+        auto next = std::chrono::steady_clock::now();
+
+        std::unique_lock<std::mutex> lock(thread_mutex_);
+        while (running_)
+        {
+            lock.unlock();
+            Tick();
+            lock.lock();
+
+            // fixed rate; after a stall continue from now instead of catching up
+            next += period_;
+            const auto now = std::chrono::steady_clock::now();
+            if (next < now)
+            {
+                next = now;
+            }
+
+            wake_.wait_until(lock, next, [this] { return !running_; });
+        }
+    }
+}
@@ -0,0 +1,249 @@
+// Dataflow runtime for the node graph editor
+//
+// The editor only describes the graph. NodeRuntime keeps its own copy of it,
+// built from the editor callbacks (see ofNodeEditor), and evaluates it on its
+// own thread: every tick the nodes run in topological order and the value of
+// each 'r' pad is copied along its links to the 'w' pads it feeds. With worker
+// threads (SetThreads) independent branches of the graph run in parallel.
+//
+// Links from pads of a format given to SetLinkBuffer are buffered: they carry
+// a queue of values through an SpscRing instead of the latest value, and do not
+// order their endpoints, so both nodes can run at the same time.
+//
+// The editor and the runtime only share a command queue, so ProcessNodes never
+// waits on data processing and data processing never waits on a frame.
+
+#pragma once
+
+#include "NodesFormats.h"
+#include "NodesRing.h"
+#include "NodesScheduler.h"
+#include "NodesTypes.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    // value carried by a pad, which member is used depends on the pad format
+    struct NodeValue
+    {
+        std::vector<float> numbers;     // "f"
+        std::string text;               // "s"
+        uint64_t tick;                  // tick that last wrote the value, 0 = never
+
+        NodeValue() : tick(0) {}
+    };
+
+    struct RuntimeNode;
+    struct RuntimeLink;
+
+    struct RuntimePad
+    {
+        std::string name;
+        uint32_t access_flags;          // NodePadAccess
+        NodeFormatId format_id;
+        NodeValue value;
+
+        std::vector<RuntimeLink*> links_out;
+    };
+
+    typedef SpscRing<NodeValue> NodeValueRing;
+
+    struct RuntimeLink
+    {
+        RuntimeNode* source_node;
+        RuntimeNode* sink_node;
+        RuntimePad* source;
+        RuntimePad* sink;
+
+        std::unique_ptr<NodeValueRing> ring;    // buffered links only
+        uint64_t dropped;                       // values lost to a full ring, producer side
+
+        RuntimeLink() : source_node(nullptr), sink_node(nullptr), source(nullptr), sink(nullptr), dropped(0) {}
+    };
+
+    class NodeProcessor;
+
+    struct RuntimeNode
+    {
+        int32_t id;
+        std::string type;
+        std::vector<RuntimePad> pads;   // same order as the editor node's pads
+        std::unique_ptr<NodeProcessor> processor; // null for types without an implementation
+
+        std::vector<RuntimeLink*> links_in;
+        std::vector<RuntimeLink*> links_out;
+
+        bool cyclic;                    // on or behind a cycle, runs after the task graph
+        uint32_t dependencies;          // links_in that are not buffered
+        std::atomic<uint32_t> remaining; // dependencies still to be evaluated this tick
+
+        RuntimeNode() : id(0), cyclic(false), dependencies(0), remaining(0) {}
+    };
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // implementation of one node type, called on the runtime thread
+    class NodeProcessor
+    {
+    public:
+        virtual ~NodeProcessor() {}
+
+        // inputs have been copied into node.pads, write outputs there as well
+        // an output written this tick (value.tick == tick) is also queued on its buffered links;
+        // to queue several values per tick Reserve/Commit on the links' rings directly
+        virtual void Process(RuntimeNode& node, uint64_t tick) = 0;
+
+        // false: buffered inputs are drained before Process and the newest value lands in the pad
+        // true: Process reads the rings of its buffered links_in itself
+        virtual bool ReadsBuffers() const { return false; }
+    };
+
+    typedef std::function<std::unique_ptr<NodeProcessor>()> NodeProcessorFactory;
+
+    // node implementations keyed by the hash of NodeType::name
+    class NodeProcessorRegistry
+    {
+        mutable std::mutex mutex_;
+        std::unordered_map<NodeTypeHash, NodeProcessorFactory> factories_;
+
+    public:
+        // inline, node libraries call it without linking against the editor
+        void Register(const std::string& type, NodeProcessorFactory factory)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            factories_[HashNodeTypeName(type)] = std::move(factory);
+        }
+
+        std::unique_ptr<NodeProcessor> Create(const std::string& type) const;
+    };
+
+    NodeProcessorRegistry& GetNodeProcessors();
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    class NodeRuntime
+    {
+    public:
+        struct PadDesc
+        {
+            std::string name;
+            uint32_t access_flags;
+            NodeFormatId format_id;
+        };
+
+    protected:
+        enum CommandType
+        {
+            Command_AddNode,
+            Command_RemoveNode,
+            Command_AddLink,
+            Command_RemoveLink,
+            Command_SetBuffer,
+            Command_Clear
+        };
+
+        struct Command
+        {
+            CommandType type;
+            int32_t node;               // node id, source node id for links
+            int32_t pad;                // source pad index for links
+            int32_t sink_node;
+            int32_t sink_pad;
+            std::string node_type;
+            std::vector<PadDesc> pads;
+            NodeFormatId format;        // Command_SetBuffer
+            size_t frames;
+            size_t reserve;
+
+            explicit Command(CommandType type, int32_t node = 0, int32_t pad = 0, int32_t sink_node = 0, int32_t sink_pad = 0)
+                : type(type), node(node), pad(pad), sink_node(sink_node), sink_pad(sink_pad), format(NodeFormat_None), frames(0), reserve(0)
+            {
+            }
+        };
+
+        // written by the editor thread, swapped out by the runtime thread at the start of a tick
+        std::mutex commands_mutex_;
+        std::vector<Command> commands_;
+        std::vector<Command> pending_;
+
+        // owned by the runtime thread
+        std::unordered_map<int32_t, std::unique_ptr<RuntimeNode>> nodes_;
+        std::vector<std::unique_ptr<RuntimeLink>> links_;
+        std::vector<RuntimeNode*> order_;   // topological, nodes on a cycle last
+        std::vector<RuntimeNode*> roots_;   // nodes without dependencies, where every tick starts
+        bool order_dirty_;
+        size_t acyclic_count_;              // order_[0 .. acyclic_count_) can run as tasks
+
+        struct LinkBuffer
+        {
+            size_t frames;
+            size_t reserve;
+        };
+        std::unordered_map<NodeFormatId, LinkBuffer> buffers_;
+
+        TaskScheduler scheduler_;
+        std::atomic<uint32_t> pending_nodes_;
+        std::mutex tick_mutex_;
+        std::atomic<uint64_t> tick_;
+
+        std::thread thread_;
+        std::mutex thread_mutex_;
+        std::condition_variable wake_;
+        std::atomic<bool> running_;
+        std::chrono::nanoseconds period_;
+
+        void Push(Command&& command);
+        void ApplyCommands();
+        void Apply(Command& command);
+        bool FindPads(const Command& command, RuntimePad*& source, RuntimePad*& sink);
+        void RemoveLink(RuntimeLink* link);
+        void SortNodes();
+        void Evaluate(RuntimeNode& node);
+        static void EvaluateTask(void* context, void* data);
+        void Run();
+
+    public:
+        NodeRuntime();
+        ~NodeRuntime();
+
+        NodeRuntime(const NodeRuntime&) = delete;
+        NodeRuntime& operator=(const NodeRuntime&) = delete;
+
+        // graph edits, safe to call from the editor thread at any time
+        void AddNode(int32_t id, const std::string& type, const std::vector<PadDesc>& pads);
+        void RemoveNode(int32_t id);
+        void AddLink(int32_t source_node, int32_t source_pad, int32_t sink_node, int32_t sink_pad);
+        void RemoveLink(int32_t source_node, int32_t source_pad, int32_t sink_node, int32_t sink_pad);
+        void Clear();
+
+        void SetTickRate(double hz);
+
+        // links added from now on whose source pad has this format get a ring of frames values,
+        // each with room for reserve numbers; frames 0 makes them direct again
+        void SetLinkBuffer(NodeFormatId format, size_t frames, size_t reserve = 0);
+
+        // worker threads for evaluation, 0 evaluates on the runtime thread alone
+        // with pin, worker i is bound to core (first_core + i) modulo the core count
+        void SetThreads(size_t workers, bool pin = false, int first_core = 0);
+
+        void Start();
+        void Stop();
+        bool IsRunning() const { return running_; }
+
+        // applies pending edits and evaluates the graph once, on the calling thread
+        void Tick();
+        uint64_t GetTick() const { return tick_; }
+    };
+}
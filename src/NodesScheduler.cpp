@@ -0,0 +1,197 @@
+// Work stealing task scheduler for the node graph runtime
+
+#include "NodesScheduler.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    bool PinCurrentThread(int core)
+    {
+#ifdef _WIN32
+        return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) != 0;
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)core; // macOS only offers affinity hints
+        return false;
+#endif
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // worker queue of the current thread, per scheduler
+    static thread_local const TaskScheduler* worker_scheduler_ = nullptr;
+    static thread_local size_t worker_index_ = 0;
+
+    TaskScheduler::TaskScheduler() : queued_(0), running_(false)
+    {
+        queues_.emplace_back(new Queue());
+    }
+
+    TaskScheduler::~TaskScheduler()
+    {
+        Stop();
+    }
+
+    void TaskScheduler::Start(size_t workers, bool pin, int first_core)
+    {
+        Stop();
+
+        queues_.clear();
+        for (size_t i = 0; i < workers + 1; ++i)
+        {
+            queues_.emplace_back(new Queue());
+        }
+
+        if (workers == 0)
+        {
+            return;
+        }
+
+        const int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+
+        running_ = true;
+        threads_.reserve(workers);
+        for (size_t i = 0; i < workers; ++i)
+        {
+            threads_.emplace_back(&TaskScheduler::Run, this, i, pin ? (first_core + (int)i) % cores : -1);
+        }
+    }
+
+    void TaskScheduler::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            running_ = false;
+        }
+        wake_.notify_all();
+
+        for (auto& thread : threads_)
+        {
+            thread.join();
+        }
+        threads_.clear();
+    }
+
+    size_t TaskScheduler::GetQueueIndex() const
+    {
+        return worker_scheduler_ == this ? worker_index_ : queues_.size() - 1;
+    }
+
+    void TaskScheduler::Submit(const SchedulerTask& task)
+    {
+        Queue& queue = *queues_[GetQueueIndex()];
+        {
+            // counted before any worker can see the task, or its --queued_ could come first and wrap
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            ++queued_;
+            queue.tasks.push_back(task);
+        }
+
+        // taking the lock orders this against a worker checking queued_ before it sleeps
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        wake_.notify_one();
+    }
+
+    bool TaskScheduler::Pop(size_t index, SchedulerTask& task)
+    {
+        Queue& queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tasks.empty())
+        {
+            return false;
+        }
+
+        // newest first, its inputs are most likely still in cache
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+        --queued_;
+        return true;
+    }
+
+    bool TaskScheduler::Steal(size_t index, SchedulerTask& task)
+    {
+        const size_t count = queues_.size();
+
+        for (size_t i = 1; i <= count; ++i)
+        {
+            Queue& queue = *queues_[(index + i) % count];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (!queue.tasks.empty())
+            {
+                // oldest first, the owner keeps working on the other end
+                task = queue.tasks.front();
+                queue.tasks.pop_front();
+                --queued_;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void TaskScheduler::Run(size_t index, int core)
+    {
+        worker_scheduler_ = this;
+        worker_index_ = index;
+
+        if (core >= 0)
+        {
+            PinCurrentThread(core);
+        }
+
+        SchedulerTask task;
+        for (;;)
+        {
+            if (Pop(index, task) || Steal(index, task))
+            {
+                task.function(task.context, task.data);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            wake_.wait(lock, [this] { return queued_ > 0 || !running_; });
+
+            if (!running_)
+            {
+                return;
+            }
+        }
+    }
+
+    void TaskScheduler::Wait(const std::atomic<uint32_t>& counter)
+    {
+        const size_t index = GetQueueIndex();
+
+        SchedulerTask task;
+        while (counter.load(std::memory_order_acquire) != 0)
+        {
+            if (Pop(index, task) || Steal(index, task))
+            {
+                task.function(task.context, task.data);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
@@ -0,0 +1,75 @@
+// Work stealing task scheduler for the node graph runtime
+//
+// Every worker owns a deque. It pushes and pops its own tasks at the back and,
+// when that runs dry, steals from the front of the others. Threads that are not
+// workers (ie the runtime thread) submit to a shared deque and help out while
+// they wait, so a tick never sleeps while there is work left.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    // plain function and argument, so submitting never allocates
+    struct SchedulerTask
+    {
+        void (*function)(void* context, void* data);
+        void* context;
+        void* data;
+    };
+
+    class TaskScheduler
+    {
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<SchedulerTask> tasks;
+        };
+
+        // queues_[0 .. workers - 1] belong to the workers, the last one is shared by everyone else
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread> threads_;
+
+        std::atomic<size_t> queued_;
+        std::atomic<bool> running_;
+        std::mutex sleep_mutex_;
+        std::condition_variable wake_;
+
+        size_t GetQueueIndex() const;
+        bool Pop(size_t index, SchedulerTask& task);
+        bool Steal(size_t index, SchedulerTask& task);
+        void Run(size_t index, int core);
+
+    public:
+        TaskScheduler();
+        ~TaskScheduler();
+
+        TaskScheduler(const TaskScheduler&) = delete;
+        TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+        // (re)starts with the given number of workers, 0 stops them
+        // with pin, worker i is bound to core (first_core + i) modulo the core count
+        void Start(size_t workers, bool pin = false, int first_core = 0);
+        void Stop();
+        size_t GetWorkerCount() const { return threads_.size(); }
+
+        void Submit(const SchedulerTask& task);
+
+        // runs tasks on the calling thread until counter drops to zero
+        void Wait(const std::atomic<uint32_t>& counter);
+    };
+
+    // binds the calling thread to one core, returns false where that is not supported
+    bool PinCurrentThread(int core);
+}
@@ -0,0 +1,234 @@
+// Type search for the node graph editor
+
+#include "NodesSearch.h"
+
+#include <algorithm>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    static std::string NormalizeName(const std::string& name)
+    {
+        std::string normalized;
+        normalized.reserve(name.size());
+
+        for (char c : name)
+        {
+            if (c >= 'A' && c <= 'Z')
+            {
+                normalized.push_back((char)(c - 'A' + 'a'));
+            }
+            else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))
+            {
+                normalized.push_back(c);
+            }
+        }
+
+        return normalized;
+    }
+
+    static void AddTrigrams(const std::string& text, std::vector<uint32_t>& trigrams)
+    {
+        for (size_t i = 0; i + 3 <= text.size(); ++i)
+        {
+            trigrams.push_back((uint32_t)(uint8_t)text[i] << 16 | (uint32_t)(uint8_t)text[i + 1] << 8 | (uint8_t)text[i + 2]);
+        }
+    }
+
+    // every character of query in name, in order
+    static bool IsSubsequence(const std::string& query, const std::string& name)
+    {
+        size_t matched = 0;
+        for (size_t i = 0; i < name.size() && matched < query.size(); ++i)
+        {
+            if (name[i] == query[matched])
+            {
+                ++matched;
+            }
+        }
+        return matched == query.size();
+    }
+
+    static void SortUnique(std::vector<uint32_t>& values)
+    {
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    void NodeTypeSearch::Update()
+    {
+        if (entries_.size() == registry_.Size())
+        {
+            return;
+        }
+
+        std::vector<uint32_t> name_trigrams;
+        std::vector<uint32_t> pad_trigrams;
+
+        for (size_t i = entries_.size(); i < registry_.Size(); ++i)
+        {
+            const NodeType& type = registry_[i];
+
+            Entry entry;
+            entry.type = &type;
+            entry.name = NormalizeName(type.name);
+
+            name_trigrams.clear();
+            pad_trigrams.clear();
+            AddTrigrams(entry.name, name_trigrams);
+
+            // trigrams never span two pad names
+            for (auto& pad : type.pads)
+            {
+                const std::string name = NormalizeName(pad.name);
+                AddTrigrams(name, pad_trigrams);
+
+                entry.pads += name;
+                entry.pads += ' ';
+            }
+
+            SortUnique(name_trigrams);
+            SortUnique(pad_trigrams);
+
+            const uint32_t index = (uint32_t)i;
+            for (uint32_t trigram : name_trigrams)
+            {
+                postings_[trigram].push_back(index << 1 | 1);
+            }
+            for (uint32_t trigram : pad_trigrams)
+            {
+                if (!std::binary_search(name_trigrams.begin(), name_trigrams.end(), trigram))
+                {
+                    postings_[trigram].push_back(index << 1);
+                }
+            }
+
+            entries_.push_back(std::move(entry));
+            sorted_.push_back(index);
+        }
+
+        std::sort(sorted_.begin(), sorted_.end(), [this](uint32_t a, uint32_t b) { return entries_[a].name < entries_[b].name; });
+    }
+
+    // direct matches rank first, then shared trigrams, then shorter names; 0 is no match
+    // without name_hit the name shares no trigram with the query and is not searched
+    int32_t NodeTypeSearch::Score(const Entry& entry, const std::string& query, uint32_t weight, bool name_hit) const
+    {
+        int32_t score = (int32_t)weight * 1000;
+
+        const size_t found = name_hit ? entry.name.find(query) : std::string::npos;
+        if (found == 0)
+        {
+            score += entry.name.size() == query.size() ? 1000000 : 500000;
+        }
+        else if (found != std::string::npos)
+        {
+            score += 250000;
+        }
+        else if (name_hit && IsSubsequence(query, entry.name))
+        {
+            score += 150000;
+        }
+        else if (entry.pads.find(query) != std::string::npos)
+        {
+            score += 100000;
+        }
+        else if (weight == 0)
+        {
+            return 0;
+        }
+
+        return std::max(score - (int32_t)entry.name.size(), 1);
+    }
+
+    void NodeTypeSearch::Query(const std::string& text, size_t max_results, std::vector<const NodeType*>& results)
+    {
+        Update();
+
+        results.clear();
+
+        const std::string query = NormalizeName(text);
+
+        if (query.empty())
+        {
+            const std::vector<const NodeType*>& sorted = registry_.GetSortedTypes();
+            results.assign(sorted.begin(), sorted.begin() + std::min(max_results, sorted.size()));
+            return;
+        }
+
+        ranked_.clear();
+
+        if (query.size() < 3)
+        {
+            auto first = std::lower_bound(sorted_.begin(), sorted_.end(), query, [this](uint32_t index, const std::string& query)
+            {
+                return entries_[index].name < query;
+            });
+
+            for (auto it = first; it != sorted_.end() && entries_[*it].name.compare(0, query.size(), query) == 0; ++it)
+            {
+                ranked_.emplace_back(Score(entries_[*it], query, 0, true), *it);
+            }
+        }
+        else
+        {
+            std::vector<uint32_t> trigrams;
+            AddTrigrams(query, trigrams);
+            SortUnique(trigrams);
+
+            weights_.resize(entries_.size(), 0);
+
+            for (uint32_t trigram : trigrams)
+            {
+                auto found = postings_.find(trigram);
+                if (found == postings_.end())
+                {
+                    continue;
+                }
+
+                for (uint32_t posting : found->second)
+                {
+                    uint32_t& weight = weights_[posting >> 1];
+                    if (weight == 0)
+                    {
+                        touched_.push_back(posting >> 1);
+                    }
+                    weight = (posting & 1) ? (weight + 2) | name_hit_ : weight + 1;
+                }
+            }
+
+            // at least half of the query in the name, or all of it across the pad names,
+            // or the name holds the query with letters left out
+            const uint32_t threshold = (uint32_t)trigrams.size();
+
+            for (uint32_t index : touched_)
+            {
+                const bool name_hit = (weights_[index] & name_hit_) != 0;
+                const uint32_t weight = weights_[index] & ~name_hit_;
+
+                if (weight >= threshold || (name_hit && IsSubsequence(query, entries_[index].name)))
+                {
+                    ranked_.emplace_back(Score(entries_[index], query, weight, name_hit), index);
+                }
+                weights_[index] = 0;
+            }
+            touched_.clear();
+        }
+
+        const size_t count = std::min(max_results, ranked_.size());
+
+        std::partial_sort(ranked_.begin(), ranked_.begin() + count, ranked_.end(), [this](const std::pair<int32_t, uint32_t>& a, const std::pair<int32_t, uint32_t>& b)
+        {
+            return a.first != b.first ? a.first > b.first : entries_[a.second].type->name < entries_[b.second].type->name;
+        });
+
+        results.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            results.push_back(entries_[ranked_[i].second].type);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+// Type search for the node graph editor
+//
+// Type and pad names are reduced to lowercase letters and digits and indexed
+// by trigram. A query of three characters or more only visits the types that
+// share a trigram with it: each shared trigram counts twice when it is in the
+// type name and once when it is only in a pad name, so a query with a typo
+// still finds its type, and so does one with missing letters as long as they
+// appear in order in the name. Shorter queries are prefixes of type names,
+// found by binary search in the sorted names.
+//
+// Types are only ever added to the registry, the index catches up with it on
+// the next query.
+
+#pragma once
+
+#include "NodesTypes.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    class NodeTypeSearch
+    {
+        static const uint32_t name_hit_ = 1u << 31;
+
+        struct Entry
+        {
+            const NodeType* type;
+            std::string name;           // normalized type name
+            std::string pads;           // normalized pad names, separated by spaces
+        };
+
+        const NodeTypeRegistry& registry_;
+        std::vector<Entry> entries_;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> postings_;  // trigram -> entry << 1 | in name
+        std::vector<uint32_t> sorted_;  // entries by normalized name
+
+        // scratch, kept between queries
+        std::vector<uint32_t> weights_;                     // shared trigrams, name_hit_ when one is in the name
+        std::vector<uint32_t> touched_;
+        std::vector<std::pair<int32_t, uint32_t>> ranked_;  // score, entry
+
+        void Update();
+        int32_t Score(const Entry& entry, const std::string& query, uint32_t weight, bool name_hit) const;
+
+    public:
+        explicit NodeTypeSearch(const NodeTypeRegistry& registry) : registry_(registry) {}
+
+        // the best max_results types for text, best first; an empty text lists types by name
+        void Query(const std::string& text, size_t max_results, std::vector<const NodeType*>& results);
+
+        size_t Size() const { return entries_.size(); }
+    };
+}
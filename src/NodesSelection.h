@@ -0,0 +1,74 @@
+// Selection set for the node graph editor
+//
+// Node ids can be any positive int32_t, ie as read from a file, so membership
+// is a hash map from id to the id's position in a densely packed array of the
+// selected ids. Adding, removing and testing an id is O(1); iterating and
+// clearing only touch the selected ids, never the whole graph.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    class NodeSelection
+    {
+        std::vector<int32_t> ids_;                      // selected ids, in no particular order
+        std::unordered_map<int32_t, uint32_t> slots_;   // position of each selected id in ids_
+
+    public:
+        bool Contains(int32_t id) const
+        {
+            return slots_.count(id) != 0;
+        }
+
+        // false when the id was already selected
+        bool Add(int32_t id)
+        {
+            if (id <= 0 || !slots_.emplace(id, (uint32_t)ids_.size()).second)
+            {
+                return false;
+            }
+
+            ids_.push_back(id);
+            return true;
+        }
+
+        // false when the id was not selected
+        bool Remove(int32_t id)
+        {
+            auto found = slots_.find(id);
+            if (found == slots_.end())
+            {
+                return false;
+            }
+
+            // swap and pop
+            const int32_t moved = ids_.back();
+            ids_[found->second] = moved;
+            slots_[moved] = found->second;
+            ids_.pop_back();
+
+            slots_.erase(id);
+            return true;
+        }
+
+        void Clear()
+        {
+            ids_.clear();
+            slots_.clear();
+        }
+
+        bool Empty() const { return ids_.empty(); }
+        size_t Size() const { return ids_.size(); }
+
+        const std::vector<int32_t>& GetIds() const { return ids_; }
+        std::vector<int32_t>::const_iterator begin() const { return ids_.begin(); }
+        std::vector<int32_t>::const_iterator end() const { return ids_.end(); }
+    };
+}
@@ -0,0 +1,210 @@
+// Uniform grid spatial index for the node graph editor
+//
+// Items are bucketed by their bounding rect in canvas space so that point and
+// rectangle queries only touch the cells they overlap instead of every item.
+
+#pragma once
+
+#define IMGUI_DEFINE_MATH_OPERATORS
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    class SpatialGrid
+    {
+        struct Entry
+        {
+            ImRect rect;
+            int32_t x0, y0, x1, y1; // covered cell range (inclusive)
+        };
+
+        struct Slot
+        {
+            T* item;
+            ImRect rect;
+            int32_t x0, y0; // first covered cell of the item, used to report it only once
+        };
+
+        float cell_size_;
+        std::unordered_map<uint64_t, std::vector<Slot>> cells_;
+        std::unordered_map<T*, Entry> entries_;
+
+        static uint64_t Key(int32_t x, int32_t y)
+        {
+            return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)y;
+        }
+
+        int32_t Cell(float v) const
+        {
+            return (int32_t)std::floor(v / cell_size_);
+        }
+
+        void Link(T* item, const Entry& entry)
+        {
+            for (int32_t y = entry.y0; y <= entry.y1; ++y)
+            {
+                for (int32_t x = entry.x0; x <= entry.x1; ++x)
+                {
+                    cells_[Key(x, y)].push_back({ item, entry.rect, entry.x0, entry.y0 });
+                }
+            }
+        }
+
+        void Unlink(T* item, const Entry& entry)
+        {
+            for (int32_t y = entry.y0; y <= entry.y1; ++y)
+            {
+                for (int32_t x = entry.x0; x <= entry.x1; ++x)
+                {
+                    auto cell = cells_.find(Key(x, y));
+                    if (cell == cells_.end()) continue;
+
+                    auto& slots = cell->second;
+                    for (size_t i = 0; i < slots.size(); ++i)
+                    {
+                        if (slots[i].item != item) continue;
+
+                        slots[i] = slots.back();
+                        slots.pop_back();
+                        break;
+                    }
+
+                    if (slots.empty())
+                    {
+                        cells_.erase(cell);
+                    }
+                }
+            }
+        }
+
+    public:
+        explicit SpatialGrid(float cell_size = 256.0f) : cell_size_(cell_size) {}
+
+        size_t Size() const { return entries_.size(); }
+
+        void Clear()
+        {
+            cells_.clear();
+            entries_.clear();
+        }
+
+        // insert an item or move it to its new bounds
+        void Update(T* item, const ImRect& rect)
+        {
+            Entry entry;
+            entry.rect = rect;
+            entry.x0 = Cell(rect.Min.x);
+            entry.y0 = Cell(rect.Min.y);
+            entry.x1 = Cell(rect.Max.x);
+            entry.y1 = Cell(rect.Max.y);
+
+            auto it = entries_.find(item);
+            if (it != entries_.end())
+            {
+                Entry& old = it->second;
+
+                // unchanged, as for most links around a group that was folded or opened
+                if (old.rect.Min.x == rect.Min.x && old.rect.Min.y == rect.Min.y && old.rect.Max.x == rect.Max.x && old.rect.Max.y == rect.Max.y)
+                {
+                    return;
+                }
+
+                // same cells: only refresh the cached bounds
+                if (old.x0 == entry.x0 && old.y0 == entry.y0 && old.x1 == entry.x1 && old.y1 == entry.y1)
+                {
+                    old.rect = rect;
+                    for (int32_t y = entry.y0; y <= entry.y1; ++y)
+                    {
+                        for (int32_t x = entry.x0; x <= entry.x1; ++x)
+                        {
+                            for (auto& slot : cells_[Key(x, y)])
+                            {
+                                if (slot.item == item) slot.rect = rect;
+                            }
+                        }
+                    }
+                    return;
+                }
+
+                Unlink(item, old);
+                old = entry;
+            }
+            else
+            {
+                entries_.emplace(item, entry);
+            }
+
+            Link(item, entry);
+        }
+
+        void Remove(T* item)
+        {
+            auto it = entries_.find(item);
+            if (it == entries_.end()) return;
+
+            Unlink(item, it->second);
+            entries_.erase(it);
+        }
+
+        // calls fn(T*) once for every item whose bounds overlap rect
+        template<typename F>
+        void Query(const ImRect& rect, F fn) const
+        {
+            const int32_t qx0 = Cell(rect.Min.x);
+            const int32_t qy0 = Cell(rect.Min.y);
+            const int32_t qx1 = Cell(rect.Max.x);
+            const int32_t qy1 = Cell(rect.Max.y);
+
+            // huge queries (zoomed far out) are cheaper over the occupied cells only
+            if ((int64_t)(qx1 - qx0 + 1) * (int64_t)(qy1 - qy0 + 1) > (int64_t)cells_.size())
+            {
+                for (auto& cell : cells_)
+                {
+                    const int32_t x = (int32_t)(cell.first >> 32);
+                    const int32_t y = (int32_t)(uint32_t)cell.first;
+                    if (x < qx0 || x > qx1 || y < qy0 || y > qy1) continue;
+
+                    Visit(cell.second, x, y, qx0, qy0, rect, fn);
+                }
+                return;
+            }
+
+            for (int32_t y = qy0; y <= qy1; ++y)
+            {
+                for (int32_t x = qx0; x <= qx1; ++x)
+                {
+                    auto cell = cells_.find(Key(x, y));
+                    if (cell == cells_.end()) continue;
+
+                    Visit(cell->second, x, y, qx0, qy0, rect, fn);
+                }
+            }
+        }
+
+    private:
+        template<typename F>
+        static void Visit(const std::vector<Slot>& slots, int32_t x, int32_t y, int32_t qx0, int32_t qy0, const ImRect& rect, F& fn)
+        {
+            for (auto& slot : slots)
+            {
+                // an item spanning several cells is only reported from the first cell shared with the query
+                if (x != ImMax(slot.x0, qx0) || y != ImMax(slot.y0, qy0)) continue;
+
+                if (slot.rect.Overlaps(rect))
+                {
+                    fn(slot.item);
+                }
+            }
+        }
+    };
+}
@@ -0,0 +1,459 @@
+// Detached part of a graph for the node graph editor
+
+#include "NodesEdit.h"
+#include "NodesSubgraph.h"
+
+#include <algorithm>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    uint32_t NodeSubgraph::AddString(const std::string& value)
+    {
+        auto found = lookup_.find(value);
+        if (found != lookup_.end())
+        {
+            return found->second;
+        }
+
+        const uint32_t index = (uint32_t)string_offsets.size();
+        string_offsets.push_back((uint32_t)string_data.size());
+        string_data.insert(string_data.end(), value.begin(), value.end());
+        string_data.push_back('\0');
+
+        lookup_.emplace(value, index);
+        return index;
+    }
+
+    void NodeSubgraph::Seal()
+    {
+        std::unordered_map<std::string, uint32_t>().swap(lookup_);
+
+        string_offsets.shrink_to_fit();
+        string_data.shrink_to_fit();
+        nodes.shrink_to_fit();
+        pads.shrink_to_fit();
+        links.shrink_to_fit();
+        members.shrink_to_fit();
+    }
+
+    void NodeSubgraph::Clear()
+    {
+        lookup_.clear();
+
+        string_offsets.clear();
+        string_data.clear();
+        nodes.clear();
+        pads.clear();
+        links.clear();
+        members.clear();
+    }
+
+    size_t NodeSubgraph::GetByteSize() const
+    {
+        return string_offsets.capacity() * sizeof(uint32_t) +
+               string_data.capacity() +
+               nodes.capacity() * sizeof(GraphFileNode) +
+               pads.capacity() * sizeof(GraphFilePad) +
+               links.capacity() * sizeof(NodeSubgraphLink) +
+               members.capacity() * sizeof(GraphFileMember);
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    void NodeEditor::StoreLink(const NodePadLink& link, NodeSubgraph& graph) const
+    {
+        const Node* source = link.source->owner;
+        const Node* sink = link.sink->owner;
+
+        NodeSubgraphLink record;
+        record.source = source->id_;
+        record.source_pad = (uint32_t)(std::find(source->pads.begin(), source->pads.end(), link.source) - source->pads.begin());
+        record.sink = sink->id_;
+        record.sink_pad = (uint32_t)(std::find(sink->pads.begin(), sink->pads.end(), link.sink) - sink->pads.begin());
+
+        graph.links.push_back(record);
+    }
+
+    // links to nodes outside the set are only kept when external_links is set, group
+    // membership always is; the pads of a group are left out, they follow from its members
+    void NodeEditor::StoreNodes(const std::vector<Node*>& nodes, NodeSubgraph& graph, bool external_links) const
+    {
+        graph.nodes.reserve(graph.nodes.size() + nodes.size());
+
+        std::vector<int32_t> ids;
+        ids.reserve(nodes.size());
+
+        for (const Node* node : nodes)
+        {
+            GraphFileNode record;
+            record.id = node->id_;
+            record.state = node->state_;
+            record.position[0] = node->position_.x;
+            record.position[1] = node->position_.y;
+            record.size[0] = node->size_.x;
+            record.size[1] = node->size_.y;
+            record.collapsed_height = node->collapsed_height;
+            record.full_height = node->full_height;
+            record.name = graph.AddString(node->name_);
+            record.type = graph.AddString(node->type_);
+            record.first_pad = (uint32_t)graph.pads.size();
+            record.pad_count = node->group_ ? 0 : (uint32_t)node->pads.size();
+
+            for (uint32_t p = 0; p < record.pad_count; ++p)
+            {
+                const NodePad* pad = node->pads[p];
+
+                GraphFilePad pad_record;
+                pad_record.name = graph.AddString(pad->name);
+                pad_record.access = graph.AddString(pad->access);
+                pad_record.format = graph.AddString(pad->format);
+                pad_record.position[0] = pad->position.x;
+                pad_record.position[1] = pad->position.y;
+                pad_record.position_out[0] = pad->position_out.x;
+                pad_record.position_out[1] = pad->position_out.y;
+
+                graph.pads.push_back(pad_record);
+            }
+
+            graph.nodes.push_back(record);
+            ids.push_back(record.id);
+
+            if (node->parent_)
+            {
+                graph.members.push_back({ node->id_, node->parent_->id_ });
+            }
+        }
+
+        std::sort(ids.begin(), ids.end());
+
+        auto inside = [&ids](const Node* node) { return std::binary_search(ids.begin(), ids.end(), node->id_); };
+
+        // every link once, a link between two of the nodes is taken from its source side
+        for (const Node* node : nodes)
+        {
+            for (const NodePad* pad : node->pads)
+            {
+                for (const NodePadLink* link : pad->links_out)
+                {
+                    if (external_links || inside(link->sink->owner))
+                    {
+                        StoreLink(*link, graph);
+                    }
+                }
+
+                for (const NodePadLink* link : pad->links_in)
+                {
+                    if (external_links && !inside(link->source->owner))
+                    {
+                        StoreLink(*link, graph);
+                    }
+                }
+            }
+        }
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // every node created from records goes through here: graph files, undo and paste; storage
+    // is reserved once for the whole batch and a stored layout is used as is. A record without
+    // a size is laid out, the first node of each type is measured for the rest of its type
+    void NodeEditor::CreateNodes(const GraphFileNode* records, size_t count, const GraphFilePad* pads, const NodeStrings& strings, ImVec2 offset, bool new_ids, std::vector<Node*>& created)
+    {
+        size_t pad_count = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            pad_count += records[i].pad_count;
+        }
+
+        node_pool_.Reserve(count);
+        pad_pool_.Reserve(pad_count);
+        nodes_.reserve(nodes_.size() + count);
+        order_.reserve(order_.size() + count);
+        node_ids_.reserve(node_ids_.size() + count);
+
+        created.clear();
+        created.reserve(count);
+
+        NodeFormatTable& formats = GetNodeFormats();
+        std::unordered_map<uint32_t, const Node*> models;    // by type string
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const GraphFileNode& record = records[i];
+
+            Node* node = node_pool_.Create();
+            node->id_ = new_ids ? ++id_ : record.id;
+            node->state_ = record.state;
+            node->position_ = ImVec2(record.position[0], record.position[1]) + offset;
+            node->size_ = ImVec2(record.size[0], record.size[1]);
+            node->collapsed_height = record.collapsed_height;
+            node->full_height = record.full_height;
+            node->name_ = strings.Get(record.name);
+            node->type_ = strings.Get(record.type);
+
+            if (new_ids)
+            {
+                // a default name follows the id, a name given by the user is kept
+                if (node->name_ == node->type_ + std::to_string(record.id))
+                {
+                    node->name_ = node->type_ + std::to_string(node->id_);
+                }
+            }
+            else
+            {
+                id_ = ImMax(id_, node->id_);
+            }
+
+            node->pads.reserve(record.pad_count);
+            for (uint32_t p = record.first_pad; p < record.first_pad + record.pad_count; ++p)
+            {
+                const GraphFilePad& pad_record = pads[p];
+
+                NodePad* pad = pad_pool_.Create();
+                pad->name = strings.Get(pad_record.name);
+                pad->access = strings.Get(pad_record.access);
+                pad->format = strings.Get(pad_record.format);
+                pad->access_flags = ParseNodePadAccess(pad->access);
+                pad->format_id = formats.Intern(pad->format);
+                pad->position = ImVec2(pad_record.position[0], pad_record.position[1]);
+                pad->position_out = ImVec2(pad_record.position_out[0], pad_record.position_out[1]);
+                pad->owner = node;
+
+                node->pads.push_back(pad);
+            }
+
+            if (record.size[0] == 0.0f && record.size[1] == 0.0f)
+            {
+                auto model = models.emplace(record.type, node);
+                LayoutNode(*node, model.second ? nullptr : model.first->second);
+
+                if (node->state_ < 0)
+                {
+                    node->size_.y = node->collapsed_height;
+                }
+            }
+
+            AttachNode(node);
+            created.push_back(node);
+        }
+    }
+
+    // links resolve their node ids through remap when given, else through the live ids;
+    // returns how many were left out because they would close a cycle
+    size_t NodeEditor::AddLinks(const NodeSubgraph& graph, const std::unordered_map<int32_t, Node*>* remap)
+    {
+        link_pool_.Reserve(graph.links.size());
+        node_links.reserve(node_links.size() + graph.links.size());
+
+        auto resolve = [&](int32_t id) -> Node*
+        {
+            if (!remap)
+            {
+                return FindNode(id);
+            }
+
+            auto found = remap->find(id);
+            return found != remap->end() ? found->second : nullptr;
+        };
+
+        // a big batch is attached as is and the order is sorted once afterwards
+        const bool bulk = graph.links.size() > 64;
+
+        std::vector<NodePadLink*> attached;
+        attached.reserve(bulk ? graph.links.size() : 0);
+        size_t dropped = 0;
+
+        for (const NodeSubgraphLink& record : graph.links)
+        {
+            Node* source = resolve(record.source);
+            Node* sink = resolve(record.sink);
+
+            if (!source || !sink || record.source_pad >= source->pads.size() || record.sink_pad >= sink->pads.size())
+            {
+                continue;
+            }
+
+            NodePad* source_pad = source->pads[record.source_pad];
+            NodePad* sink_pad = sink->pads[record.sink_pad];
+
+            if (bulk)
+            {
+                attached.push_back(AttachLink(source_pad, sink_pad));
+            }
+            else if (!AddNodePadLink(source_pad, sink_pad))
+            {
+                LinkRejected(source_pad, sink_pad);
+                ++dropped;
+            }
+        }
+
+        const size_t cyclic = bulk ? RebuildOrder() : 0;
+
+        if (cyclic)
+        {
+            // links made since the batch was stored, like those of an undone delete, can close a
+            // cycle through it; every such cycle runs through the nodes left at the end of the order,
+            // so the batch links between those go and are added again one at a time
+            const uint32_t first = (uint32_t)(order_.size() - cyclic);
+
+            std::vector<std::pair<NodePad*, NodePad*>> retry;
+            for (NodePadLink* link : attached)
+            {
+                if (link->source->owner->order_ >= first && link->sink->owner->order_ >= first)
+                {
+                    retry.emplace_back(link->source, link->sink);
+                    DeleteNodePadLink(link);
+                }
+            }
+
+            RebuildOrder();
+
+            for (auto& pads : retry)
+            {
+                if (!AddNodePadLink(pads.first, pads.second))
+                {
+                    LinkRejected(pads.first, pads.second);
+                    ++dropped;
+                }
+            }
+        }
+
+        return dropped;
+    }
+
+    void NodeEditor::InsertSubgraph(const NodeSubgraph& graph, ImVec2 offset, bool new_ids, std::vector<Node*>& created)
+    {
+        CreateNodes(graph.nodes.data(), graph.nodes.size(), graph.pads.data(), graph.GetStrings(), offset, new_ids, created);
+
+        std::unordered_map<int32_t, Node*> remap;
+
+        if (new_ids)
+        {
+            remap.reserve(created.size());
+
+            for (size_t i = 0; i < created.size(); ++i)
+            {
+                remap.emplace(graph.nodes[i].id, created[i]);
+            }
+        }
+
+        AddLinks(graph, new_ids ? &remap : nullptr);
+
+        auto resolve = [&](int32_t id) -> Node*
+        {
+            if (!new_ids)
+            {
+                return FindNode(id);
+            }
+
+            auto found = remap.find(id);
+            return found != remap.end() ? found->second : nullptr;
+        };
+
+        for (const GraphFileMember& member : graph.members)
+        {
+            Node* node = resolve(member.node);
+            Node* group = resolve(member.group);
+
+            if (node && group && group->group_)
+            {
+                SetParent(*node, group);
+            }
+        }
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    // a selected group brings every node inside it along, each node is listed once
+    void NodeEditor::GetSelectedNodes(std::vector<Node*>& nodes) const
+    {
+        nodes.clear();
+        nodes.reserve(selection_.Size());
+
+        for (int32_t id : selection_)
+        {
+            nodes.push_back(FindNode(id));
+        }
+
+        // selected members are already listed, so are their own members
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            for (Node* member : nodes[i]->members_)
+            {
+                if (!selection_.Contains(member->id_))
+                {
+                    nodes.push_back(member);
+                }
+            }
+        }
+    }
+
+    // pasted nodes come in under new ids, selected, as one undo step
+    void NodeEditor::PasteSubgraph(const NodeSubgraph& graph, ImVec2 offset)
+    {
+        std::vector<Node*> created;
+        InsertSubgraph(graph, offset, true, created);
+
+        selection_.Clear();
+        for (Node* node : created)
+        {
+            selection_.Add(node->id_);
+        }
+
+        cur_node_.Reset(NodeState_Selected);
+        RecordCreate(created);
+    }
+
+    bool NodeEditor::CopySelection()
+    {
+        if (selection_.Empty())
+        {
+            return false;
+        }
+
+        std::vector<Node*> selected;
+        GetSelectedNodes(selected);
+
+        clipboard_.Clear();
+        StoreNodes(selected, clipboard_, false);
+        clipboard_.Seal();
+        return true;
+    }
+
+    bool NodeEditor::PasteClipboard(ImVec2 position)
+    {
+        if (clipboard_.nodes.empty())
+        {
+            return false;
+        }
+
+        // the top left corner of the copied nodes goes to position
+        ImVec2 corner(FLT_MAX, FLT_MAX);
+        for (const GraphFileNode& record : clipboard_.nodes)
+        {
+            corner = ImMin(corner, ImVec2(record.position[0], record.position[1]));
+        }
+
+        PasteSubgraph(clipboard_, position - corner);
+        return true;
+    }
+
+    bool NodeEditor::DuplicateSelection()
+    {
+        if (selection_.Empty())
+        {
+            return false;
+        }
+
+        std::vector<Node*> selected;
+        GetSelectedNodes(selected);
+
+        NodeSubgraph graph;
+        StoreNodes(selected, graph, false);
+
+        PasteSubgraph(graph, ImVec2(20.0f, 20.0f));
+        return true;
+    }
+}
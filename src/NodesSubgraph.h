@@ -0,0 +1,62 @@
+// Detached part of a graph for the node graph editor
+//
+// Nodes and pads are kept as the fixed size records of the binary graph file
+// (see NodesFile.h) with a string table of their own, shared by every node of
+// the subgraph. Links refer to nodes by id and to pads by slot, so a subgraph
+// stays meaningful after its nodes are destroyed, and can be created again
+// under the same ids (undo) or under new ones (paste). Group membership is
+// kept by id as well; a member whose group is not part of a pasted subgraph
+// comes in at the top level.
+
+#pragma once
+
+#include "NodesFile.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    // string table of a set of graph file records, in a file or in a subgraph
+    struct NodeStrings
+    {
+        const uint32_t* offsets;
+        const char* data;
+
+        const char* Get(uint32_t index) const { return data + offsets[index]; }
+    };
+
+    struct NodeSubgraphLink
+    {
+        int32_t source;             // node id
+        uint32_t source_pad;        // slot in the node's pads
+        int32_t sink;               // node id
+        uint32_t sink_pad;          // slot in the node's pads
+    };
+
+    // GraphFileNode::first_pad indexes pads
+    struct NodeSubgraph
+    {
+        std::vector<uint32_t> string_offsets;
+        std::vector<char> string_data;      // NUL terminated
+        std::vector<GraphFileNode> nodes;
+        std::vector<GraphFilePad> pads;
+        std::vector<NodeSubgraphLink> links;
+        std::vector<GraphFileMember> members;
+
+        uint32_t AddString(const std::string& value);
+        NodeStrings GetStrings() const { return { string_offsets.data(), string_data.data() }; }
+
+        // drops the string lookup and spare capacity once the subgraph is complete
+        void Seal();
+        void Clear();
+        size_t GetByteSize() const;
+
+    private:
+        std::unordered_map<std::string, uint32_t> lookup_;
+    };
+}
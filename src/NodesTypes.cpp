@@ -0,0 +1,59 @@
+// Node type registry for the node graph editor
+
+#include "NodesTypes.h"
+
+#include <algorithm>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    NodeTypeRegistry::NodeTypeRegistry() : sorted_dirty_(false)
+    {
+        Register(
+        {
+            { std::string("MOCAPBridge") },
+
+            {
+                { std::string("Trigger"), std::string("sw"), std::string("f") },
+                { std::string("Markers"), std::string("re"), std::string("f") },
+                { std::string("Skeleton"), std::string("re"), std::string("f") }
+            }
+        });
+
+        Register(
+        {
+            { std::string("OSCSender") },
+
+            {
+                { std::string("Host Address"), std::string("sw"), std::string("s") },
+                { std::string("data"), std::string("w"), std::string("f") },
+            }
+        });
+    }
+
+    const std::vector<const NodeType*>& NodeTypeRegistry::GetSortedTypes() const
+    {
+        if (sorted_dirty_ || sorted_.size() != types_.size())
+        {
+            sorted_.clear();
+            sorted_.reserve(types_.size());
+
+            for (auto& type : types_)
+            {
+                sorted_.push_back(type.get());
+            }
+
+            std::sort(sorted_.begin(), sorted_.end(), [](const NodeType* a, const NodeType* b) { return a->name < b->name; });
+            sorted_dirty_ = false;
+        }
+
+        return sorted_;
+    }
+
+    NodeTypeRegistry& GetNodeTypes()
+    {
+        static NodeTypeRegistry types;
+        return types;
+    }
+}
@@ -0,0 +1,111 @@
+// Node type registry for the node graph editor
+//
+// Types are kept by a 64 bit FNV-1a hash of their name, so finding the type
+// of a node read from a file is one hash of the name and one table probe.
+// Types can be registered at any time, the built-in ones are there from the
+// start and node libraries add theirs at runtime (see NodesPlugins.h).
+//
+// A registered type is never moved or removed, pointers to it stay valid for
+// the lifetime of the program. The registry belongs to the editor thread.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ImGui
+{
+	////////////////////////////////////////////////////////////////////////////////
+
+    struct NodePadType
+    {
+        std::string name;
+        std::string access;
+        std::string format;
+    };
+
+    struct NodeType
+    {
+        std::string name;
+        std::vector<NodePadType> pads;
+    };
+
+    // type_ of group nodes, never registered as a NodeType: a group's pads are made from its members
+    static const char* const node_group_type_ = "#Group";
+
+    typedef uint64_t NodeTypeHash;
+
+    inline NodeTypeHash HashNodeTypeName(const char* name, size_t length)
+    {
+        NodeTypeHash hash = 14695981039346656037ull;
+        for (size_t i = 0; i < length; ++i)
+        {
+            hash ^= (uint8_t)name[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    inline NodeTypeHash HashNodeTypeName(const std::string& name)
+    {
+        return HashNodeTypeName(name.data(), name.size());
+    }
+
+	////////////////////////////////////////////////////////////////////////////////
+
+    class NodeTypeRegistry
+    {
+        std::vector<std::unique_ptr<NodeType>> types_;          // in registration order
+        std::unordered_map<NodeTypeHash, const NodeType*> hashes_;
+        mutable std::vector<const NodeType*> sorted_;           // by name, rebuilt after a registration
+        mutable bool sorted_dirty_;
+
+    public:
+        NodeTypeRegistry();
+
+        // false when the name is empty, taken or node_group_type_, or its hash collides with another name
+        // inline, node libraries call it without linking against the editor
+        bool Register(const NodeType& type)
+        {
+            if (type.name.empty() || type.name == node_group_type_)
+            {
+                return false;
+            }
+
+            const NodeTypeHash hash = HashNodeTypeName(type.name);
+            if (hashes_.count(hash))
+            {
+                return false;
+            }
+
+            types_.emplace_back(new NodeType(type));
+            hashes_.emplace(hash, types_.back().get());
+            sorted_dirty_ = true;
+
+            return true;
+        }
+
+        const NodeType* Find(NodeTypeHash hash) const
+        {
+            auto found = hashes_.find(hash);
+            return found != hashes_.end() ? found->second : nullptr;
+        }
+
+        const NodeType* Find(const std::string& name) const
+        {
+            const NodeType* type = Find(HashNodeTypeName(name));
+            return type && type->name == name ? type : nullptr;
+        }
+
+        size_t Size() const { return types_.size(); }
+        const NodeType& operator[](size_t index) const { return *types_[index]; }
+
+        // for menus, sorted once after registrations rather than every frame
+        const std::vector<const NodeType*>& GetSortedTypes() const;
+    };
+
+    NodeTypeRegistry& GetNodeTypes();
+}
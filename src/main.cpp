@@ -2,7 +2,7 @@
 #include "ofApp.h"
 
 //========================================================================
-int main( ){
+int main(int argc, char* argv[]){
     //ofSetupOpenGL(1024,768,OF_WINDOW);			// <-------- setup the GL context
     ofGLWindowSettings settings;
     settings.setSize(1280, 720);
@@ -12,6 +12,8 @@ int main( ){
     // this kicks off the running of my app
     // can be OF_WINDOW or OF_FULLSCREEN
     // pass in width and height too:
-    ofRunApp(new ofApp());
+    ofApp* app = new ofApp();
+    app->parseArguments(argc, argv);
+    ofRunApp(app);
 
 }
@@ -1,7 +1,31 @@
 #include "ofApp.h"
 #include "NodesEdit.h"
+#include "NodesPlugins.h"
 #include "ofNodeEditor.h"
 
+//--------------------------------------------------------------
+void ofApp::parseArguments(int argc, char* argv[]){
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc && argv[i + 1][0] != '-';
+
+        if (arg == "--threads" && has_value)
+        {
+            runtimeThreads = std::max(ofToInt(argv[++i]), 0);
+        }
+        else if (arg == "--pin")
+        {
+            runtimePin = true;
+            if (has_value) runtimeFirstCore = ofToInt(argv[++i]);
+        }
+        else
+        {
+            ofLogWarning() << "Unknown argument " << arg;
+        }
+    }
+}
+
 //--------------------------------------------------------------
 void ofApp::setup(){
     ofSetLogLevel(OF_LOG_VERBOSE);
@@ -12,9 +36,25 @@ void ofApp::setup(){
     io.MouseDrawCursor = false;
     io.Fonts->AddFontDefault();
     io.Fonts->AddFontFromFileTTF("/home/arnaud/src/imgui/misc/fonts/Roboto-Medium.ttf", 16.0f);
+
+    // node libraries from data/plugins add their types to the context menu
+    ImGui::NodePluginApi api = { ImGui::NodePluginApi_Version, &ImGui::GetNodeTypes(), &ImGui::GetNodeProcessors() };
+    std::vector<std::string> errors;
+    ImGui::LoadNodePlugins(ofToDataPath("plugins", true), api, &errors);
+    for (auto& error : errors)
+    {
+        ofLogError() << "Could not load node library " << error;
+    }
+
+    // by default leave a core for the ui and one for the runtime thread itself
+    const unsigned cores = std::thread::hardware_concurrency();
+    const size_t threads = runtimeThreads >= 0 ? (size_t)runtimeThreads : (cores > 2 ? cores - 2 : 0);
+    nodes.runtime.SetThreads(threads, runtimePin, runtimeFirstCore);
+    nodes.runtime.Start();
+
     gui.setup();
     gui.begin();
-    nodes.CreateNodeFromType(ImVec2(400,140), ImGui::node_types[0]);
+    nodes.CreateNodeFromType(ImVec2(400,140), ImGui::GetNodeTypes()[0]);
     gui.end();
 }
 
@@ -31,11 +71,29 @@ void ofApp::doGui() {
     {
         if (ImGui::BeginMenu("File"))
         {
-            if (ImGui::MenuItem("Open ...", "Ctrl+O")) {  }
-            if (ImGui::MenuItem("Save ...", "Ctrl+S"))   { }
+            if (ImGui::MenuItem("Open ...", "Ctrl+O")) { openPatch(); }
+            if (ImGui::MenuItem("Save ...", "Ctrl+S"))   { savePatch(); }
+            ImGui::Separator();
+            if (ImGui::MenuItem("Import JSON ...")) { importPatch(); }
+            if (ImGui::MenuItem("Export JSON ...")) { exportPatch(); }
+            ImGui::Separator();
             if (ImGui::MenuItem("Exit", "Ctrl+W"))  { ofExit(0); }
             ImGui::EndMenu();
         }
+        if (ImGui::BeginMenu("Edit"))
+        {
+            if (ImGui::MenuItem("Undo", "Ctrl+Z", false, nodes.CanUndo())) { nodes.Undo(); }
+            if (ImGui::MenuItem("Redo", "Ctrl+Y", false, nodes.CanRedo())) { nodes.Redo(); }
+            ImGui::EndMenu();
+        }
+        if (ImGui::BeginMenu("View"))
+        {
+            bool profiler = nodes.IsProfilerVisible();
+            if (ImGui::MenuItem("Profiler", NULL, &profiler)) { nodes.SetProfilerVisible(profiler); }
+            bool retained = nodes.IsRetainedRendering();
+            if (ImGui::MenuItem("Retained Rendering", NULL, &retained)) { nodes.SetRetainedRendering(retained); }
+            ImGui::EndMenu();
+        }
         mainmenu_height = ImGui::GetWindowSize().y;
         ImGui::EndMainMenuBar();
     }
@@ -47,6 +105,62 @@ void ofApp::doGui() {
     gui.end();
 }
 
+//--------------------------------------------------------------
+void ofApp::openPatch(){
+    ofFileDialogResult result = ofSystemLoadDialog("Open patch");
+    if (!result.bSuccess) return;
+
+    if (!nodes.LoadGraph(result.getPath()))
+    {
+        ofLogError() << "Could not open patch " << result.getPath();
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::savePatch(){
+    ofFileDialogResult result = ofSystemSaveDialog("patch.ofng", "Save patch");
+    if (!result.bSuccess) return;
+
+    if (!nodes.SaveGraph(result.getPath()))
+    {
+        ofLogError() << "Could not save patch " << result.getPath();
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::importPatch(){
+    ofFileDialogResult result = ofSystemLoadDialog("Import patch");
+    if (!result.bSuccess) return;
+
+    // the import blocks the ui, report every tenth of the file instead
+    int reported = -10;
+    auto progress = [&reported](uint64_t read, uint64_t total)
+    {
+        const int percent = total ? (int)(read * 100 / total) : 0;
+        if (percent / 10 != reported / 10)
+        {
+            reported = percent;
+            ofLogNotice() << "Importing patch: " << percent << "%";
+        }
+    };
+
+    if (!nodes.ImportJson(result.getPath(), progress))
+    {
+        ofLogError() << "Could not import patch " << result.getPath();
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::exportPatch(){
+    ofFileDialogResult result = ofSystemSaveDialog("patch.json", "Export patch");
+    if (!result.bSuccess) return;
+
+    if (!nodes.ExportJson(result.getPath()))
+    {
+        ofLogError() << "Could not export patch " << result.getPath();
+    }
+}
+
 //--------------------------------------------------------------
 void ofApp::draw(){
     doGui();
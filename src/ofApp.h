@@ -8,9 +8,17 @@
 class ofApp : public ofBaseApp{
 
 public:
+    // --threads n: runtime worker threads, default all cores but one for the ui and one for the runtime
+    // --pin [core]: bind worker i to core (core + i), from core 0 when none is given
+    void parseArguments(int argc, char* argv[]);
+
     void setup();
     void update();
     void doGui();
+    void openPatch();
+    void savePatch();
+    void importPatch();
+    void exportPatch();
     void draw();
 
     void keyPressed(int key);
@@ -27,4 +35,8 @@ public:
 
     ofxImGui::Gui gui;
     ofNodeEditor nodes;
+
+    int runtimeThreads = -1;    // < 0 = from the core count
+    bool runtimePin = false;
+    int runtimeFirstCore = 0;
 };
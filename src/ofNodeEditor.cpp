@@ -1,18 +1,107 @@
 #include "ofNodeEditor.h"
+#include "ofxOsc.h"
 
-ofNodeEditor::ofNodeEditor()
+////////////////////////////////////////////////////////////////////////////////
+
+// sends the "data" pad to "Host Address" ("host:port") whenever it changed this tick
+class OSCSenderProcessor : public ImGui::NodeProcessor
 {
+    ofxOscSender sender_;
+    std::string address_;
+    bool ready_ = false;
+
+public:
+    void Process(ImGui::RuntimeNode& node, uint64_t tick) override
+    {
+        // the processor goes by type name alone, an imported node may bring pads of its own
+        if (node.pads.size() < 2)
+        {
+            return;
+        }
+
+        const ImGui::NodeValue& address = node.pads[0].value;
+        const ImGui::NodeValue& data = node.pads[1].value;
+
+        const std::string& target = address.text.empty() ? std::string("localhost:9000") : address.text;
+        if (target != address_ || !ready_)
+        {
+            address_ = target;
+
+            const size_t colon = address_.rfind(':');
+            const std::string host = address_.substr(0, colon);
+            const int port = colon == std::string::npos ? 9000 : ofToInt(address_.substr(colon + 1));
+
+            sender_.setup(host, port);
+            ready_ = true;
+        }
+
+        if (data.tick != tick)
+        {
+            return;
+        }
 
+        ofxOscMessage message;
+        message.setAddress("/data");
+        for (float value : data.numbers)
+        {
+            message.addFloatArg(value);
+        }
+        sender_.sendMessage(message, false);
+    }
+};
+
+static int32_t GetPadIndex(const ImGui::NodeEditor::NodePad* pad)
+{
+    const auto& pads = pad->owner->pads;
+    return (int32_t)(std::find(pads.begin(), pads.end(), pad) - pads.begin());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ofNodeEditor::ofNodeEditor()
+{
+    ImGui::GetNodeProcessors().Register("OSCSender", [] { return std::unique_ptr<ImGui::NodeProcessor>(new OSCSenderProcessor()); });
 }
 
 void ofNodeEditor::LinkAdded(ImGui::NodeEditor::NodePad*& src, ImGui::NodeEditor::NodePad*& sink)
 {
 
     ofLogVerbose() << "New Connection: source=" << src->owner->name_ << ":" << " to " << sink->owner->name_;
+
+    runtime.AddLink(src->owner->id_, GetPadIndex(src), sink->owner->id_, GetPadIndex(sink));
 }
 
 void ofNodeEditor::LinkDeleted(ImGui::NodeEditor::NodePad*& src, ImGui::NodeEditor::NodePad*& sink)
 {
 
     ofLogVerbose() << "Delete Connection: source=" << src->owner->name_ << " to " << sink->owner->name_;
+
+    runtime.RemoveLink(src->owner->id_, GetPadIndex(src), sink->owner->id_, GetPadIndex(sink));
+}
+
+void ofNodeEditor::LinkRejected(ImGui::NodeEditor::NodePad*& src, ImGui::NodeEditor::NodePad*& sink)
+{
+    ofLogWarning() << "Dropped Connection closing a cycle: source=" << src->owner->name_ << " to " << sink->owner->name_;
+}
+
+void ofNodeEditor::NodeAdded(ImGui::NodeEditor::Node& node)
+{
+    std::vector<ImGui::NodeRuntime::PadDesc> pads;
+    pads.reserve(node.pads.size());
+    for (auto& pad : node.pads)
+    {
+        pads.push_back({ pad->name, pad->access_flags, pad->format_id });
+    }
+
+    runtime.AddNode(node.id_, node.type_, pads);
+}
+
+void ofNodeEditor::NodeDeleted(ImGui::NodeEditor::Node& node)
+{
+    runtime.RemoveNode(node.id_);
+}
+
+void ofNodeEditor::GraphCleared()
+{
+    runtime.Clear();
 }
@@ -3,6 +3,7 @@
 
 #include "ofMain.h"
 #include "NodesEdit.h"
+#include "NodesRuntime.h"
 
 class ofNodeEditor : public ImGui::NodeEditor
 {
@@ -11,6 +12,14 @@ public:
 
     void LinkAdded(ImGui::NodeEditor::NodePad*& src, ImGui::NodeEditor::NodePad*& sink);
     void LinkDeleted(ImGui::NodeEditor::NodePad*& src, ImGui::NodeEditor::NodePad*& sink);
+    void LinkRejected(ImGui::NodeEditor::NodePad*& src, ImGui::NodeEditor::NodePad*& sink);
+    void NodeAdded(ImGui::NodeEditor::Node& node);
+    void NodeDeleted(ImGui::NodeEditor::Node& node);
+    void GraphCleared();
+
+    // executes the graph on its own thread, fed by the callbacks above; the owner sets
+    // its threads and starts it (see ofApp::setup)
+    ImGui::NodeRuntime runtime;
 };
 
 #endif // OFNODEEDITOR_H